@@ -0,0 +1,499 @@
+// Measures the kernels of every instruction-set tier that the running
+// processor supports, independent of any I/O, and reports the results as JSON
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <chrono>
+#include <utility>
+#include <vector>
+#include <getopt.h>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include <x86intrin.h>
+#endif
+
+#include "Base2-Kernels.hpp"
+
+struct Settings
+{
+	const char* Tier   = nullptr;
+	const char* Kernel = nullptr;
+	// Largest size of binary data measured
+	std::size_t MaxSize = 16 * 1024 * 1024;
+	// Minimum duration of each timed trial
+	double MinTime      = 0.005;
+};
+
+/// Cycle counting
+
+// Core cycles come from a hardware performance counter where the system
+// allows it, otherwise from the time-stamp counter which ticks at a constant
+// reference rate regardless of the core's clock
+class CycleCounter
+{
+public:
+	CycleCounter()
+	{
+	#if defined(__linux__)
+		perf_event_attr Attributes = {};
+		Attributes.type           = PERF_TYPE_HARDWARE;
+		Attributes.size           = sizeof(Attributes);
+		Attributes.config         = PERF_COUNT_HW_CPU_CYCLES;
+		Attributes.exclude_kernel = 1;
+		Attributes.exclude_hv     = 1;
+		PerfFD = syscall(SYS_perf_event_open, &Attributes, 0, -1, -1, 0);
+		if( PerfFD >= 0 )
+		{
+			ioctl(PerfFD, PERF_EVENT_IOC_ENABLE, 0);
+			Source = "perf";
+			return;
+		}
+	#endif
+	#if defined(__x86_64__) || defined(_M_X64)
+		Source = "tsc";
+	#endif
+	}
+
+	~CycleCounter()
+	{
+	#if defined(__linux__)
+		if( PerfFD >= 0 )
+		{
+			close(PerfFD);
+		}
+	#endif
+	}
+
+	CycleCounter( const CycleCounter& ) = delete;
+	CycleCounter& operator=( const CycleCounter& ) = delete;
+
+	std::uint64_t Read() const
+	{
+	#if defined(__linux__)
+		std::uint64_t Cycles = 0;
+		if( PerfFD >= 0 && read(PerfFD, &Cycles, sizeof(Cycles)) == sizeof(Cycles) )
+		{
+			return Cycles;
+		}
+	#endif
+	#if defined(__x86_64__) || defined(_M_X64)
+		return __rdtsc();
+	#else
+		return 0;
+	#endif
+	}
+
+	// `perf`, `tsc`, or `none` when cycles cannot be counted
+	const char* Source = "none";
+
+private:
+	int PerfFD = -1;
+};
+
+/// Measurement
+
+struct Timing
+{
+	double Seconds = 0.0;
+	double Cycles  = 0.0;
+};
+
+// Best time and cycle count of a single call of `Run`, out of several trials
+// that each repeat it for at least `MinTime` seconds
+template<typename RunT>
+Timing Measure(
+	const Settings& Settings, const CycleCounter& Counter, RunT&& Run
+)
+{
+	using Clock = std::chrono::steady_clock;
+	constexpr std::size_t TrialCount = 3;
+	std::size_t Repeats = 1;
+	Timing Best = {};
+	for( std::size_t Trial = 0; Trial < TrialCount; )
+	{
+		const std::uint64_t StartCycles = Counter.Read();
+		const Clock::time_point Start = Clock::now();
+		for( std::size_t i = 0; i < Repeats; ++i )
+		{
+			Run();
+		}
+		const double Seconds
+			= std::chrono::duration<double>(Clock::now() - Start).count();
+		const std::uint64_t Cycles = Counter.Read() - StartCycles;
+		if( Seconds < Settings.MinTime )
+		{
+			// Grow the trial until it is long enough to time reliably
+			Repeats *= 2;
+			continue;
+		}
+		if( Trial == 0 || Seconds / Repeats < Best.Seconds )
+		{
+			Best.Seconds = Seconds / Repeats;
+			Best.Cycles  = static_cast<double>(Cycles) / Repeats;
+		}
+		++Trial;
+	}
+	return Best;
+}
+
+/// Input data
+
+// Deterministic pseudo-random bytes
+void FillRandom( std::uint8_t Bytes[], std::size_t Length, std::uint64_t Seed )
+{
+	std::uint64_t State = Seed * 0x9E3779B97F4A7C15ULL + 1;
+	for( std::size_t i = 0; i < Length; ++i )
+	{
+		State ^= State << 13;
+		State ^= State >> 7;
+		State ^= State << 17;
+		Bytes[i] = static_cast<std::uint8_t>(State >> 24);
+	}
+}
+
+// Ascii-binary where each byte has been replaced by a non-digit byte with a
+// probability of `Density`
+void FillGarbled(
+	std::uint8_t Bytes[], std::size_t Length, double Density, std::uint64_t Seed
+)
+{
+	FillRandom(Bytes, Length, Seed);
+	const std::uint32_t Threshold
+		= static_cast<std::uint32_t>(Density * 0xFFFF);
+	std::uint64_t State = Seed + 0x2545F4914F6CDD1DULL;
+	for( std::size_t i = 0; i < Length; ++i )
+	{
+		State ^= State << 13;
+		State ^= State >> 7;
+		State ^= State << 17;
+		if( (State & 0xFFFF) < Threshold )
+		{
+			// Any byte but `0` or `1`
+			Bytes[i] = (Bytes[i] & 0xFE) == '0' ? ' ' : Bytes[i];
+		}
+		else
+		{
+			Bytes[i] = '0' | (Bytes[i] & 1);
+		}
+	}
+}
+
+/// Neighbouring workload
+
+// Chases pointers through a cache-resident working set in a random order,
+// standing in for another workload on the same core whose working set a
+// kernel may evict
+class Neighbour
+{
+public:
+	static constexpr std::size_t Size = 1024 * 1024;
+
+	Neighbour()
+	: Next(Size / sizeof(std::uint32_t))
+	{
+		// A single cycle through every slot, in a pseudo-random order
+		std::vector<std::uint32_t> Order(Next.size());
+		for( std::size_t i = 0; i < Order.size(); ++i )
+		{
+			Order[i] = static_cast<std::uint32_t>(i);
+		}
+		std::uint64_t State = 0x9E3779B97F4A7C15ULL;
+		for( std::size_t i = Order.size() - 1; i > 0; --i )
+		{
+			State ^= State << 13;
+			State ^= State >> 7;
+			State ^= State << 17;
+			std::swap(Order[i], Order[State % (i + 1)]);
+		}
+		for( std::size_t i = 0; i < Order.size(); ++i )
+		{
+			Next[Order[i]] = Order[(i + 1) % Order.size()];
+		}
+	}
+
+	void Run()
+	{
+		std::uint32_t Cur = Last;
+		for( std::size_t i = 0; i < Next.size(); ++i )
+		{
+			Cur = Next[Cur];
+		}
+		Last = Cur;
+	}
+
+private:
+	std::vector<std::uint32_t> Next;
+	std::uint32_t Last = 0;
+};
+
+/// Reporting
+
+void Report(
+	bool& First, const char* Kernel, const char* Tier, std::size_t Size,
+	bool Aligned, const char* Data, double Garbage, std::size_t Bytes,
+	const Timing& Timing, const CycleCounter& Counter
+)
+{
+	constexpr double GiB = 1024.0 * 1024.0 * 1024.0;
+	std::printf(
+		"%s\n    {\"Kernel\": \"%s\", \"Tier\": \"%s\", \"Size\": %zu, "
+		"\"Aligned\": %s, \"Data\": \"%s\", \"Garbage\": %g, "
+		"\"Bytes\": %zu, \"Seconds\": %.9g, \"GiBPerSecond\": %.4f, ",
+		First ? "" : ",", Kernel, Tier, Size, Aligned ? "true" : "false", Data,
+		Garbage, Bytes, Timing.Seconds,
+		Timing.Seconds > 0.0 ? Bytes / Timing.Seconds / GiB : 0.0
+	);
+	if( std::strcmp(Counter.Source, "none") != 0 && Bytes )
+	{
+		std::printf("\"CyclesPerByte\": %.4f}", Timing.Cycles / Bytes);
+	}
+	else
+	{
+		std::printf("\"CyclesPerByte\": null}");
+	}
+	std::fflush(stdout);
+	First = false;
+}
+
+bool Selected( const char* Filter, const char* Name )
+{
+	return Filter == nullptr || std::strcmp(Filter, Name) == 0;
+}
+
+const char* Usage =
+"base2-bench - Measures the kernels of each supported instruction-set tier\n"
+"Usage: base2-bench [Options]...\n"
+"Options:\n"
+"  -h, --help              Display this help/usage information\n"
+"  -t, --tier=Name         Only measure the named tier\n"
+"  -k, --kernel=Name       Only measure `Encode`, `EncodeNonTemporal`,\n"
+"                          `Decode`, `Filter`, or `Neighbour`\n"
+"  -s, --max-size=Bytes    Largest size of binary data to measure\n"
+"                          Default is `16777216`\n"
+"  -m, --min-time=Millis   Minimum duration of each timed trial\n"
+"                          Default is `5`\n";
+
+const static struct option CommandOptions[6] = {
+	{ "tier",     required_argument, nullptr,  't' },
+	{ "kernel",   required_argument, nullptr,  'k' },
+	{ "max-size", required_argument, nullptr,  's' },
+	{ "min-time", required_argument, nullptr,  'm' },
+	{ "help",     optional_argument, nullptr,  'h' },
+	{ nullptr,          no_argument, nullptr, '\0' }
+};
+
+int main( int argc, char* argv[] )
+{
+	Settings CurSettings = {};
+	int Opt;
+	int OptionIndex;
+	while( (Opt = getopt_long(argc, argv, "ht:k:s:m:", CommandOptions, &OptionIndex )) != -1 )
+	{
+		switch( Opt )
+		{
+		case 't': CurSettings.Tier = optarg;   break;
+		case 'k': CurSettings.Kernel = optarg; break;
+		case 's':
+		{
+			CurSettings.MaxSize = std::strtoull(optarg, nullptr, 10);
+			if( CurSettings.MaxSize == 0 )
+			{
+				std::fputs("Invalid maximum size", stderr);
+				return EXIT_FAILURE;
+			}
+			break;
+		}
+		case 'm':
+		{
+			CurSettings.MinTime = std::atof(optarg) / 1000.0;
+			if( CurSettings.MinTime <= 0.0 )
+			{
+				std::fputs("Invalid minimum time", stderr);
+				return EXIT_FAILURE;
+			}
+			break;
+		}
+		case 'h':
+		{
+			std::puts(Usage);
+			return EXIT_SUCCESS;
+		}
+		default:
+		{
+			return EXIT_FAILURE;
+		}
+		}
+	}
+
+	const std::vector<Base2::Kernels::Tier> Tiers
+		= Base2::Kernels::SupportedTiers();
+	const CycleCounter Counter;
+	Neighbour Neighbour;
+
+	// Binary data and its ascii-binary form, with room to offset either of
+	// them by a byte to measure unaligned buffers
+	const std::size_t MaxSize = CurSettings.MaxSize;
+	std::vector<std::uint64_t> BinaryStore(MaxSize / 8 + 2);
+	std::vector<std::uint64_t> AsciiStore(MaxSize + 1);
+	std::vector<std::uint64_t> PristineStore(MaxSize + 1);
+	std::uint8_t* const BinaryBase
+		= reinterpret_cast<std::uint8_t*>(BinaryStore.data());
+	std::uint8_t* const AsciiBase
+		= reinterpret_cast<std::uint8_t*>(AsciiStore.data());
+	std::uint8_t* const PristineBase
+		= reinterpret_cast<std::uint8_t*>(PristineStore.data());
+
+	// Sizes from a single byte to an ascii-binary form that exceeds the
+	// last-level cache, in powers of 4
+	std::vector<std::size_t> Sizes;
+	for( std::size_t Size = 1; Size <= MaxSize; Size *= 4 )
+	{
+		Sizes.push_back(Size);
+	}
+
+	std::printf("{\n  \"CycleSource\": \"%s\",\n  \"Tiers\": [", Counter.Source);
+	for( std::size_t i = 0; i < Tiers.size(); ++i )
+	{
+		std::printf("%s\"%s\"", i ? ", " : "", Tiers[i].Name);
+	}
+	std::printf("],\n  \"Results\": [");
+
+	bool First = true;
+	for( const Base2::Kernels::Tier& Tier : Tiers )
+	{
+		if( !Selected(CurSettings.Tier, Tier.Name) ) continue;
+		const Base2::Kernels::Table& Kernels = *Tier.Kernels;
+		for( const std::size_t Size : Sizes )
+		{
+			for( const bool Aligned : { true, false } )
+			{
+				std::uint8_t* const Binary = BinaryBase + !Aligned;
+				std::uint8_t* const Ascii  = AsciiBase + !Aligned;
+				std::uint8_t* const Pristine = PristineBase + !Aligned;
+				std::uint64_t* const AsciiWords
+					= reinterpret_cast<std::uint64_t*>(Ascii);
+
+				for( const bool Random : { false, true } )
+				{
+					const char* const Data = Random ? "random" : "zero";
+					if( Random )
+					{
+						FillRandom(Binary, Size, Size);
+					}
+					else
+					{
+						std::memset(Binary, 0, Size);
+					}
+					if( Selected(CurSettings.Kernel, "Encode") )
+					{
+						const Timing Encoded = Measure(
+							CurSettings, Counter,
+							[&]{ Kernels.Encode(Binary, AsciiWords, Size); }
+						);
+						Report(
+							First, "Encode", Tier.Name, Size, Aligned, Data, 0.0,
+							Size, Encoded, Counter
+						);
+					}
+					if( Selected(CurSettings.Kernel, "EncodeNonTemporal") )
+					{
+						const Timing Encoded = Measure(
+							CurSettings, Counter,
+							[&]
+							{
+								Kernels.EncodeNonTemporal(Binary, AsciiWords, Size);
+							}
+						);
+						Report(
+							First, "EncodeNonTemporal", Tier.Name, Size, Aligned,
+							Data, 0.0, Size, Encoded, Counter
+						);
+					}
+					if( Random && Selected(CurSettings.Kernel, "Neighbour") )
+					{
+						// The neighbouring workload runs after each call of an
+						// encoding kernel, and its time is what remains after
+						// removing the time of the kernel alone. Its `Data` is
+						// the kernel that it ran alongside.
+						const std::pair<const char*, Base2::Kernels::EncodeFunc>
+							Encoders[] = {
+								{ "Encode", Kernels.Encode },
+								{ "EncodeNonTemporal", Kernels.EncodeNonTemporal }
+							};
+						for( const auto& [Name, Encoder] : Encoders )
+						{
+							const Timing Alone = Measure(
+								CurSettings, Counter,
+								[&]{ Encoder(Binary, AsciiWords, Size); }
+							);
+							Timing Shared = Measure(
+								CurSettings, Counter,
+								[&]
+								{
+									Encoder(Binary, AsciiWords, Size);
+									Neighbour.Run();
+								}
+							);
+							Shared.Seconds = std::max(Shared.Seconds - Alone.Seconds, 0.0);
+							Shared.Cycles  = std::max(Shared.Cycles - Alone.Cycles, 0.0);
+							Report(
+								First, "Neighbour", Tier.Name, Size, Aligned, Name,
+								0.0, Neighbour::Size, Shared, Counter
+							);
+						}
+					}
+					if( Selected(CurSettings.Kernel, "Decode") )
+					{
+						Kernels.Encode(Binary, AsciiWords, Size);
+						const Timing Decoded = Measure(
+							CurSettings, Counter,
+							[&]{ Kernels.Decode(AsciiWords, Binary, Size); }
+						);
+						Report(
+							First, "Decode", Tier.Name, Size, Aligned, Data, 0.0,
+							Size * 8, Decoded, Counter
+						);
+					}
+				}
+
+				if( !Selected(CurSettings.Kernel, "Filter") ) continue;
+				// Filtering compacts its input in place, so each call is given
+				// a fresh copy whose cost is measured separately and removed
+				const Timing Copied = Measure(
+					CurSettings, Counter,
+					[&]{ std::memcpy(Ascii, Pristine, Size * 8); }
+				);
+				for( const double Garbage : { 0.0, 0.01, 0.1, 0.5 } )
+				{
+					FillGarbled(Pristine, Size * 8, Garbage, Size);
+					Timing Filtered = Measure(
+						CurSettings, Counter,
+						[&]
+						{
+							std::memcpy(Ascii, Pristine, Size * 8);
+							Kernels.Filter(Ascii, Size * 8);
+						}
+					);
+					Filtered.Seconds = std::max(Filtered.Seconds - Copied.Seconds, 0.0);
+					Filtered.Cycles  = std::max(Filtered.Cycles - Copied.Cycles, 0.0);
+					Report(
+						First, "Filter", Tier.Name, Size, Aligned, "ascii", Garbage,
+						Size * 8, Filtered, Counter
+					);
+				}
+			}
+		}
+	}
+	std::printf("\n  ]\n}\n");
+	return EXIT_SUCCESS;
+}
@@ -1,20 +1,524 @@
 #pragma once
 #include <cstdint>
 #include <cstddef>
+#include <memory>
+#include <vector>
 
 namespace Base2
 {
 
+/// Instruction sets
+
+// Tiers of kernels, each compiled for an instruction set. Every tier of the
+// target architecture is carried by the library, and unless another one is
+// selected, the kernels of the widest tier that the running processor
+// supports are used. The `BASE2_ISA` environment variable, such as
+// `BASE2_ISA=avx2`, selects the default tier when it names a supported one.
+enum class Isa : std::uint8_t
+{
+	// The default tier
+	Auto,
+	// SSE2 on x86-64, 64-bit SWAR elsewhere
+	Generic,
+	// SSSE3 + SSE4.1
+	SSE41,
+	// AVX2 + BMI2
+	AVX2,
+	// AVX512F + AVX512BW + BMI2
+	AVX512BW,
+	// AVX512F + AVX512BW + AVX512BITALG + AVX512VBMI2 + BMI2
+	AVX512BITALG,
+	// SSSE3 + SSE4.1 + GFNI
+	SSE41GFNI,
+	// AVX2 + BMI2 + GFNI
+	AVX2GFNI,
+	// AVX512F + AVX512BW + BMI2 + GFNI
+	AVX512GFNI,
+	// ARMv8 Advanced SIMD
+	NEON,
+};
+
+// Whether the tier is carried by the library and supported by the running
+// processor. `Isa::Auto` is always supported.
+bool IsaSupported(Isa Tier);
+
+// Lower-case name of the tier, such as `avx2`
+const char* IsaName(Isa Tier);
+
+// Parses the name of a tier, in any case. Returns false for unknown names.
+bool ParseIsa(const char* Name, Isa& Tier);
+
+// Tier that the kernels are currently selected from
+Isa SelectedIsa();
+
+// Selects the tier that every following call uses, with `Isa::Auto` returning
+// to the default tier. Returns false, without changing the selection, if the
+// tier is not supported. Should be called before any other thread transcodes.
+bool SelectIsa(Isa Tier);
+
+/// Encoding and decoding
+
+// Every function reads and writes only within the lengths that it is given,
+// and never past either end of a buffer, even in the vectorized tails of its
+// kernels. Buffers may be sized exactly, such as network buffers or slices of
+// an arena, and need no alignment beyond that of their element type.
+
+// Encodes `Length` bytes into `Length` groups of 8 ascii-binary bytes
 void Encode(
 	const std::uint8_t Input[], std::uint64_t Output[], std::size_t Length
 );
 
+// `Encode` using the kernels of the given tier, or of the selected tier if
+// the given one is not supported
+void Encode(
+	const std::uint8_t Input[], std::uint64_t Output[], std::size_t Length,
+	Isa Tier
+);
+
+// `Encode` that writes `Output` with non-temporal stores, which bypass the
+// cache, where the selected tier has them
+void EncodeNonTemporal(
+	const std::uint8_t Input[], std::uint64_t Output[], std::size_t Length
+);
+
+// `Encode` writes 8 bytes for every byte of input. Outputs larger than this
+// many bytes are written with `EncodeNonTemporal`, so that encoding a large
+// buffer does not evict the working set of everything else on the core.
+// Defaults to the size of the L2 cache. A threshold of `0` streams every
+// output, and `SIZE_MAX` none of them.
+std::size_t NonTemporalThreshold();
+
+void SetNonTemporalThreshold(std::size_t Bytes);
+
 void Decode(
 	const std::uint64_t Input[], std::uint8_t Output[], std::size_t Length
 );
 
+// `Decode` using the kernels of the given tier, or of the selected tier if
+// the given one is not supported
+void Decode(
+	const std::uint64_t Input[], std::uint8_t Output[], std::size_t Length,
+	Isa Tier
+);
+
+// Decodes `Length` groups of 8 ascii-binary bytes while validating that every
+// byte is a `0` or `1`. Returns the offset of the first invalid byte within
+// `Input`, or `Length * 8` if every byte is valid. Every group before the one
+// with the invalid byte is decoded into `Output`.
+std::size_t DecodeChecked(
+	const std::uint64_t Input[], std::uint8_t Output[], std::size_t Length
+);
+
+// Encodes `Length` bytes using multiple threads. The input is split into
+// chunks that are encoded by a pool of threads into their final positions
+// within `Output`. A `ThreadCount` of `0` uses all hardware threads.
+void ParallelEncode(
+	const std::uint8_t Input[], std::uint64_t Output[], std::size_t Length,
+	std::size_t ThreadCount = 0
+);
+
+// Encodes `Length` bytes into ascii-binary with a newline placed before any
+// digit that would go past `WrapWidth` columns, starting at column `Column`.
+// Returns the column that the output ends at. A `WrapWidth` of `0` disables
+// line-wrapping. `Output` must have room for `WrappedSize(...)` bytes.
+std::size_t EncodeWrapped(
+	const std::uint8_t Input[], char Output[], std::size_t Length,
+	std::size_t WrapWidth, std::size_t Column = 0
+);
+
+// Number of bytes that `EncodeWrapped` writes for `Length` bytes of input
+std::size_t WrappedSize(
+	std::size_t Length, std::size_t WrapWidth, std::size_t Column = 0
+);
+
+// Column that `EncodeWrapped` ends at for `Length` bytes of input
+std::size_t WrappedColumn(
+	std::size_t Length, std::size_t WrapWidth, std::size_t Column = 0
+);
+
+// Multi-threaded `EncodeWrapped`.
+// A `ThreadCount` of `0` uses all hardware threads.
+std::size_t ParallelEncodeWrapped(
+	const std::uint8_t Input[], char Output[], std::size_t Length,
+	std::size_t WrapWidth, std::size_t Column = 0, std::size_t ThreadCount = 0
+);
+
+// Decodes `Length` groups of 8 ascii-binary bytes using multiple threads.
+// A `ThreadCount` of `0` uses all hardware threads.
+void ParallelDecode(
+	const std::uint64_t Input[], std::uint8_t Output[], std::size_t Length,
+	std::size_t ThreadCount = 0
+);
+
+// Multi-threaded `DecodeChecked`.
+// A `ThreadCount` of `0` uses all hardware threads.
+std::size_t ParallelDecodeChecked(
+	const std::uint64_t Input[], std::uint8_t Output[], std::size_t Length,
+	std::size_t ThreadCount = 0
+);
+
+// Decodes `Length` bytes of ascii-binary that may contain garbage bytes using
+// multiple threads. `Input` is filtered in place, and every complete group of
+// 8 `0` and `1` digits is decoded into `Output`. Returns the total number of
+// digits found. The final `Digits % 8` digits that do not form a complete
+// group are moved to the front of `Input` so that they may be continued by
+// the next call. A `ThreadCount` of `0` uses all hardware threads.
+std::size_t ParallelFilterDecode(
+	std::uint8_t Input[], std::uint8_t Output[], std::size_t Length,
+	std::size_t ThreadCount = 0
+);
+
+// Digits of an incomplete group of 8 that `FilterDecode` and `DecodeWrapped`
+// carry over from one call to the next, along with the column of the line
+// that `DecodeWrapped` is on. Begin each stream with a default-constructed
+// carry.
+struct DecodeCarry
+{
+	std::uint8_t Digits = 0;
+	std::uint8_t Count  = 0;
+	std::size_t  Column = 0;
+};
+
+// Decodes `Length` bytes of ascii-binary that may contain garbage bytes in a
+// single pass, skipping any byte that is not a `0` or `1`. Digits that do not
+// complete a group of 8 are kept in `Carry` and continued by the next call.
+// Returns the number of bytes written to `Output`, which must have room for
+// `(Carry.Count + Length) / 8` bytes.
+std::size_t FilterDecode(
+	const std::uint8_t Input[], std::uint8_t Output[], std::size_t Length,
+	DecodeCarry& Carry
+);
+
+// Decodes `Length` bytes of ascii-binary that is expected to be laid out in
+// lines of `WrapWidth` digits, each ending in a `\n` or `\r\n`, such as the
+// output of `EncodeWrapped`. Lines that match the layout have their line
+// endings skipped at their expected columns and their digits decoded in bulk.
+// Lines that do not are filtered like `FilterDecode`, so the result is always
+// the same as that of `FilterDecode`. A `WrapWidth` of `0` is `FilterDecode`.
+// Returns the number of bytes written to `Output`, which must have room for
+// `(Carry.Count + Length) / 8` bytes.
+std::size_t DecodeWrapped(
+	const std::uint8_t Input[], std::uint8_t Output[], std::size_t Length,
+	std::size_t WrapWidth, DecodeCarry& Carry
+);
+
+// Decodes a stream of ascii-binary in lines of `WrapWidth` digits that
+// arrives in arbitrarily sized chunks, failing upon the first byte that
+// breaks the layout. Every line but the last must be exactly `WrapWidth`
+// digits followed by a `\n` or `\r\n`, and the last line may be shorter, with
+// or without a line ending. The digits of each chunk are staged without their
+// line endings, and then validated and decoded at once.
+class CheckedWrapDecoder
+{
+public:
+	// `WrapWidth` must not be `0`. A `ThreadCount` of `0` uses all hardware
+	// threads.
+	explicit CheckedWrapDecoder(
+		std::size_t WrapWidth, std::size_t ThreadCount = 1
+	);
+
+	// Most bytes that `Update` may write for `Length` bytes of input
+	std::size_t MaxOutputSize(std::size_t Length) const;
+
+	// Decodes `Length` bytes into `Output`, which must have room for
+	// `MaxOutputSize(Length)` bytes. Returns the number of bytes written. Upon
+	// the first byte that breaks the layout, every group before it is still
+	// decoded, `Failed()` becomes true, and no more input is decoded.
+	std::size_t Update(
+		const std::uint8_t Input[], std::size_t Length, std::uint8_t Output[]
+	);
+
+	// Ends the stream, which fails if its last byte is a `\r` of its own.
+	// Returns the number of digits of an incomplete final group that were not
+	// decoded.
+	std::size_t Finish();
+
+	// Whether a byte broke the layout, the offset of it within the stream, and
+	// its value
+	bool Failed() const;
+	std::uint64_t FailedOffset() const;
+	std::uint8_t FailedByte() const;
+
+private:
+	// Where a run of staged digits came from within the chunk
+	struct Span
+	{
+		std::size_t Staged;
+		std::size_t Input;
+	};
+
+	std::vector<std::uint64_t> Block;
+	std::vector<Span> Spans;
+	std::size_t WrapWidth;
+	std::size_t ThreadCount;
+	// Digits of an incomplete group at the front of the block
+	std::size_t Carried         = 0;
+	std::size_t Column          = 0;
+	std::uint64_t InputOffset   = 0;
+	bool Invalid                = false;
+	std::uint64_t InvalidOffset = 0;
+	std::uint8_t InvalidByte    = 0;
+	// A `\r` was the last byte, and a `\n` must be the next one
+	bool PendingLF              = false;
+	// A line shorter than the width ended, which must have been the last one.
+	// Where the line ending of it, or the last `\r`, is within the stream.
+	bool Ended                  = false;
+	std::uint64_t EndedOffset   = 0;
+	std::uint8_t EndedByte      = 0;
+};
+
+/// Formatted encoding
+
+// Longest that each of the texts of a `Format` may be
+constexpr std::size_t MaxFormatText = 16;
+
+// Layout of ascii-binary with text around the digits of each byte, such as
+// `0b01010001,`, and between groups of bytes, such as `01010001 01010111`.
+// The digits of every byte are placed between `Prefix` and `Suffix`, and every
+// group of `GroupSize` bytes but the first is preceded by `Separator`.
+struct Format
+{
+	const char* Prefix    = "";
+	const char* Suffix    = "";
+	const char* Separator = " ";
+	std::size_t GroupSize = 1;
+};
+
+// Whether a format may be encoded and decoded. Its `GroupSize` must not be
+// `0`, each of its texts must be at most `MaxFormatText` bytes, and a text
+// that contains a `0` or `1`, such as `0b`, must also contain some other byte
+// for it to be told apart from digits.
+bool FormatValid(const Format& Format);
+
+// Number of bytes that `EncodeFormatted` writes for `Length` bytes of input
+std::size_t FormattedSize(
+	std::size_t Length, const Format& Format, std::uint64_t Position = 0
+);
+
+namespace Kernels
+{
+struct FormatRecord;
+}
+
+// Encodes in a valid `Format` whose records are laid out once, along with
+// the tables that the kernels store them with, rather than upon every call.
+// A stream that is encoded in many pieces, or by many threads, should share
+// one of these.
+class FormattedEncoder
+{
+public:
+	explicit FormattedEncoder(const Format& Format);
+	~FormattedEncoder();
+
+	// Encodes `Length` bytes. `Position` is the offset of the first byte
+	// within the stream that it is a part of, which decides where the
+	// separators fall, so that a stream may be encoded in pieces and in any
+	// order. `Output` must have room for `FormattedSize(...)` bytes. Returns
+	// the number of bytes written.
+	std::size_t Encode(
+		const std::uint8_t Input[], char Output[], std::size_t Length,
+		std::uint64_t Position = 0
+	) const;
+
+	// Multi-threaded `Encode`.
+	// A `ThreadCount` of `0` uses all hardware threads.
+	std::size_t ParallelEncode(
+		const std::uint8_t Input[], char Output[], std::size_t Length,
+		std::uint64_t Position = 0, std::size_t ThreadCount = 0
+	) const;
+
+private:
+	std::unique_ptr<const Kernels::FormatRecord> Record;
+};
+
+// `FormattedEncoder::Encode` with a `FormattedEncoder` of its own
+std::size_t EncodeFormatted(
+	const std::uint8_t Input[], char Output[], std::size_t Length,
+	const Format& Format, std::uint64_t Position = 0
+);
+
+// `FormattedEncoder::ParallelEncode` with a `FormattedEncoder` of its own
+std::size_t ParallelEncodeFormatted(
+	const std::uint8_t Input[], char Output[], std::size_t Length,
+	const Format& Format, std::uint64_t Position = 0,
+	std::size_t ThreadCount = 0
+);
+
+// Decodes a stream of ascii-binary in a valid `Format` that arrives in
+// arbitrarily sized chunks. The texts of the format that contain digits are
+// skipped wherever they appear, and every other byte that is not a `0` or `1`
+// is skipped like `FilterDecode`, so spacing and line endings that differ
+// from the format are tolerated. The end of a chunk that may be the start of
+// a text is held back until the next chunk tells.
+class FormattedDecoder
+{
+public:
+	explicit FormattedDecoder(const Format& Format);
+
+	// Most bytes that `Update` may write for `Length` bytes of input
+	std::size_t MaxOutputSize(std::size_t Length) const;
+
+	// Decodes `Length` bytes into `Output`, which must have room for
+	// `MaxOutputSize(Length)` bytes. Returns the number of bytes written.
+	std::size_t Update(
+		const std::uint8_t Input[], std::size_t Length, std::uint8_t Output[]
+	);
+
+	// Ends the stream, decoding the bytes that were held back into `Output`,
+	// which must have room for `MaxOutputSize(0)` bytes, and starts a new one.
+	// Returns the number of bytes written.
+	std::size_t Finish(std::uint8_t Output[]);
+
+private:
+	// A text of the format that contains digits, found by the first byte of it
+	// that is not a digit
+	struct Text
+	{
+		char Bytes[MaxFormatText] = {};
+		std::size_t Length        = 0;
+		std::size_t Anchor        = 0;
+	};
+
+	Text Texts[3];
+	std::size_t TextCount    = 0;
+	std::uint8_t Held[MaxFormatText] = {};
+	std::size_t HeldLength   = 0;
+	DecodeCarry Carry;
+};
+
+/// Streaming
+
+// Encodes a stream of bytes that arrives in arbitrarily sized chunks, keeping
+// the column of the current line between chunks. Every chunk is encoded in
+// full, so there is never any output left to flush.
+class StreamEncoder
+{
+public:
+	// A `WrapWidth` of `0` disables line-wrapping
+	explicit StreamEncoder(std::size_t WrapWidth = 0);
+
+	// Number of bytes that `Update` writes for `Length` bytes of input
+	std::size_t OutputSize(std::size_t Length) const;
+
+	// Encodes `Length` bytes into `Output`, which must have room for
+	// `OutputSize(Length)` bytes. Returns the number of bytes written.
+	std::size_t Update(
+		const std::uint8_t Input[], std::size_t Length, char Output[]
+	);
+
+	// Starts a new stream at the first column
+	void Reset();
+
+private:
+	std::size_t WrapWidth;
+	std::size_t Column = 0;
+};
+
+// Decodes a stream of ascii-binary that arrives in arbitrarily sized chunks,
+// skipping any byte that is not a `0` or `1`. Digits of a group that is split
+// between chunks are kept until the rest of the group arrives.
+class StreamDecoder
+{
+public:
+	// Input that is laid out in lines of `WrapWidth` digits is decoded with
+	// `DecodeWrapped`. A `WrapWidth` of `0` expects no particular layout.
+	explicit StreamDecoder(std::size_t WrapWidth = 0);
+
+	// Most bytes that `Update` may write for `Length` bytes of input
+	std::size_t MaxOutputSize(std::size_t Length) const;
+
+	// Decodes `Length` bytes into `Output`, which must have room for
+	// `MaxOutputSize(Length)` bytes. Returns the number of bytes written.
+	std::size_t Update(
+		const std::uint8_t Input[], std::size_t Length, std::uint8_t Output[]
+	);
+
+	// Ends the stream and starts a new one. Returns the number of digits of an
+	// incomplete final group that were discarded, which is `0` for a stream
+	// that ended cleanly.
+	std::size_t Finish();
+
+private:
+	std::size_t WrapWidth;
+	DecodeCarry Carry;
+};
+
 // Filters a given array of bytes so that all `0` and `1` bytes are filtered
 // towards the front of the array, and returns the new length of the array
 std::size_t Filter(std::uint8_t Bytes[], std::size_t Length);
 
+/// Random access
+
+// Offset of the first digit of byte `Offset` within ascii-binary laid out in
+// lines of `WrapWidth` digits, each followed by a line ending of `EndingSize`
+// bytes, such as the output of `EncodeWrapped` with its `\n` line endings. A
+// `WrapWidth` of `0` has no line endings.
+std::uint64_t WrappedOffset(
+	std::uint64_t Offset, std::size_t WrapWidth, std::size_t EndingSize = 1
+);
+
+// Decodes ranges of bytes out of ascii-binary that is held in memory as a
+// whole, such as a memory-mapped file, without decoding everything before
+// them. Input laid out in lines as wide as its first one, each ending in a
+// `\n` or `\r\n`, has the digits of a range located with `WrappedOffset`.
+// Any other input, or input that does not agree with that layout around a
+// range, has them located through a sparse index of the number of digits
+// before every `IndexSpacing` bytes, which is only built as far into the input
+// as the ranges have reached. Bytes that are not a `0` or `1` are skipped,
+// like `FilterDecode`.
+class RangeDecoder
+{
+public:
+	// Bytes of input between the positions that the index holds
+	static constexpr std::size_t IndexSpacing = 64 * 1024;
+
+	// `Input` must remain valid for as long as the decoder is used
+	RangeDecoder(const std::uint8_t Input[], std::size_t Length);
+
+	// Width of the lines of the input, `0` when it is a single line
+	std::size_t WrapWidth() const;
+
+	// Whether the input was found to be laid out in lines of `WrapWidth`
+	// digits, until a range that did not agree with the layout
+	bool Regular() const;
+
+	// Decodes up to `Length` bytes starting at byte `Offset` into `Output`.
+	// Returns the number of bytes written, which is less than `Length` when
+	// the input ends first.
+	std::size_t Decode(
+		std::uint64_t Offset, std::size_t Length, std::uint8_t Output[]
+	);
+
+private:
+	// Number of digits before a position within the input
+	struct Checkpoint
+	{
+		std::size_t Position = 0;
+		std::uint64_t Digits = 0;
+	};
+
+	// Finds the position of digit `Digit` through the index, or the end of
+	// the input if there are not that many digits
+	std::size_t Locate(std::uint64_t Digit);
+
+	// Decodes up to `Length` bytes from the digits at `Position`, which is
+	// advanced past the input that was decoded. `Column` is that of
+	// `Position` when the input is regular.
+	std::size_t DecodeFrom(
+		std::size_t& Position, std::size_t Column, std::size_t Length,
+		std::uint8_t Output[]
+	);
+
+	const std::uint8_t* Input;
+	std::size_t Length;
+	std::size_t Width       = 0;
+	std::size_t EndingSize  = 1;
+	// Number of bytes that regular input decodes into
+	std::uint64_t Size      = 0;
+	bool IsRegular          = false;
+	std::vector<Checkpoint> Index;
+	// Where the last range through the index ended, to continue from
+	Checkpoint Cursor;
+};
+
 }
@@ -0,0 +1,57 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <algorithm>
+
+#include <Base2.hpp>
+
+#include "Base2-Kernels.hpp"
+
+// Garbage-tolerant decoding that copies the input into a staging block,
+// filters it there with `Filter`, and decodes the complete groups with
+// `Decode`. Shared by every tier that has no fused kernel of its own.
+// The carried digits are kept in stream order starting from the lowest bit.
+
+namespace
+{
+
+// Bytes of input filtered within a staging block at a time. The block stays
+// within the L1 cache so that the input is only read from memory once.
+constexpr std::size_t FilterBlockSize = 4096;
+
+inline std::size_t FilterDecodeStaged(
+	Base2::Kernels::FilterFunc Filter, Base2::Kernels::DecodeFunc Decode,
+	const std::uint8_t Input[], std::uint8_t Output[], std::size_t Length,
+	Base2::DecodeCarry& Carry
+)
+{
+	// Room for the carried digits in front of the block
+	alignas(64) std::uint8_t Block[FilterBlockSize + 8];
+	const std::uint8_t* OutputStart = Output;
+	for( std::size_t i = 0; i < Length; i += FilterBlockSize )
+	{
+		const std::size_t BlockLength = std::min(FilterBlockSize, Length - i);
+		// Put the carried digits back in front of the new ones
+		for( std::size_t k = 0; k < Carry.Count; ++k )
+		{
+			Block[k] = '0' + ((Carry.Digits >> k) & 1);
+		}
+		std::memcpy(Block + Carry.Count, Input + i, BlockLength);
+		const std::size_t Digits
+			= Carry.Count + Filter(Block + Carry.Count, BlockLength);
+
+		Decode(reinterpret_cast<const std::uint64_t*>(Block), Output, Digits / 8);
+		Output += Digits / 8;
+
+		Carry.Count = Digits % 8;
+		Carry.Digits = 0;
+		for( std::size_t k = 0; k < Carry.Count; ++k )
+		{
+			Carry.Digits |= (Block[Digits - Carry.Count + k] & 1) << k;
+		}
+	}
+	return Output - OutputStart;
+}
+
+}
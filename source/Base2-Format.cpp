@@ -0,0 +1,247 @@
+#include <Base2.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+
+#include "Base2-Kernels.hpp"
+
+namespace
+{
+inline bool IsDigit( std::uint8_t Byte )
+{
+	return (Byte & 0xFE) == 0x30;
+}
+
+// Offset of the first byte of `Text` that is not a digit, or its length when
+// it is all digits
+std::size_t FirstNonDigit( const char* Text )
+{
+	std::size_t i = 0;
+	while( Text[i] && IsDigit(static_cast<std::uint8_t>(Text[i])) )
+	{
+		++i;
+	}
+	return i;
+}
+
+// Number of separators before the bytes of a stream up until `Position`
+std::uint64_t SeparatorCount( std::uint64_t Position, std::size_t GroupSize )
+{
+	return Position ? (Position - 1) / GroupSize : 0;
+}
+
+// Bytes of input that are staged along with the ones that were held back
+constexpr std::size_t FormatStageSize = 4096;
+}
+
+bool Base2::FormatValid( const Format& Format )
+{
+	if( Format.GroupSize == 0 )
+	{
+		return false;
+	}
+	for( const char* Text : {Format.Prefix, Format.Suffix, Format.Separator} )
+	{
+		if( Text == nullptr )
+		{
+			return false;
+		}
+		const std::size_t Length = std::strlen(Text);
+		if( Length > MaxFormatText )
+		{
+			return false;
+		}
+		// A text of only digits could not be told apart from the digits
+		if( Length && FirstNonDigit(Text) == Length )
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+std::size_t Base2::FormattedSize(
+	std::size_t Length, const Format& Format, std::uint64_t Position
+)
+{
+	const std::size_t RecordSize
+		= std::strlen(Format.Prefix) + 8 + std::strlen(Format.Suffix);
+	const std::uint64_t Separators
+		= SeparatorCount(Position + Length, Format.GroupSize)
+		- SeparatorCount(Position, Format.GroupSize);
+	return Length * RecordSize
+		+ static_cast<std::size_t>(Separators) * std::strlen(Format.Separator);
+}
+
+Base2::Kernels::FormatRecord::FormatRecord( const Base2::Format& Format )
+	: GroupSize(Format.GroupSize)
+{
+	const auto Append = [&]( const char* Bytes )
+	{
+		const std::size_t Length = std::strlen(Bytes);
+		std::memcpy(Text + Size, Bytes, Length);
+		Size += Length;
+	};
+	if( GroupSize == 1 )
+	{
+		Append(Format.Separator);
+		Lead = Size;
+	}
+	else
+	{
+		SeparatorSize = std::strlen(Format.Separator);
+		std::memcpy(Separator, Format.Separator, SeparatorSize);
+	}
+	Append(Format.Prefix);
+	DigitOffset = Size;
+	Size += 8;
+	Append(Format.Suffix);
+	if( GroupSize != 1 )
+	{
+		return;
+	}
+	for( std::size_t Phase = 0; Phase < Size; ++Phase )
+	{
+		for( std::size_t j = 0; j < 64; ++j )
+		{
+			const std::size_t Offset = (Phase + j) % Size;
+			Templates[Phase][j] = Text[Offset];
+			if( Offset - DigitOffset < 8 )
+			{
+				Slots[Phase] |= std::uint64_t(1) << j;
+				++Taken[Phase];
+			}
+		}
+	}
+}
+
+std::size_t Base2::Kernels::FormatRecord::FormattedSize(
+	std::size_t Length, std::uint64_t Position
+) const
+{
+	const std::uint64_t Separators
+		= SeparatorCount(Position + Length, GroupSize)
+		- SeparatorCount(Position, GroupSize);
+	return Length * (Size - Lead)
+		+ static_cast<std::size_t>(Separators) * (SeparatorSize + Lead);
+}
+
+Base2::FormattedEncoder::FormattedEncoder( const Format& Format )
+	: Record(new Kernels::FormatRecord(Format))
+{
+}
+
+Base2::FormattedEncoder::~FormattedEncoder() = default;
+
+Base2::FormattedDecoder::FormattedDecoder( const Format& Format )
+{
+	for( const char* Bytes : {Format.Prefix, Format.Suffix, Format.Separator} )
+	{
+		const std::size_t Length = std::strlen(Bytes);
+		const std::size_t Anchor = FirstNonDigit(Bytes);
+		// Texts without digits are skipped along with any other garbage
+		if( std::none_of(
+			Bytes, Bytes + Length,
+			[]( char Byte ) { return IsDigit(static_cast<std::uint8_t>(Byte)); }
+		) )
+		{
+			continue;
+		}
+		Text& Entry = Texts[TextCount++];
+		std::memcpy(Entry.Bytes, Bytes, Length);
+		Entry.Length = Length;
+		Entry.Anchor = Anchor;
+	}
+}
+
+std::size_t Base2::FormattedDecoder::MaxOutputSize( std::size_t Length ) const
+{
+	return (Carry.Count + HeldLength + Length) / 8;
+}
+
+std::size_t Base2::FormattedDecoder::Update(
+	const std::uint8_t Input[], std::size_t Length, std::uint8_t Output[]
+)
+{
+	if( TextCount == 0 )
+	{
+		return Base2::FilterDecode(Input, Output, Length, Carry);
+	}
+	std::uint8_t Stage[FormatStageSize + MaxFormatText];
+	std::size_t Written = 0;
+	while( Length )
+	{
+		const std::size_t Take = std::min(Length, FormatStageSize);
+		std::memcpy(Stage, Held, HeldLength);
+		std::memcpy(Stage + HeldLength, Input, Take);
+		const std::size_t StageLength = HeldLength + Take;
+		Input += Take;
+		Length -= Take;
+
+		// Blank out every whole text, found by its anchor, so that its digits
+		// are skipped along with the rest of it
+		for( std::size_t t = 0; t < TextCount; ++t )
+		{
+			const Text& Entry = Texts[t];
+			const std::uint8_t* Found = Stage + Entry.Anchor;
+			const std::uint8_t* StageEnd = Stage + StageLength;
+			while( Found < StageEnd )
+			{
+				Found = static_cast<const std::uint8_t*>(std::memchr(
+					Found, Entry.Bytes[Entry.Anchor], StageEnd - Found
+				));
+				if( Found == nullptr )
+				{
+					break;
+				}
+				std::uint8_t* Start = Stage + (Found - Stage) - Entry.Anchor;
+				if(
+					std::size_t(StageEnd - Start) >= Entry.Length
+					&& std::memcmp(Start, Entry.Bytes, Entry.Length) == 0
+				)
+				{
+					std::memset(Start, ' ', Entry.Length);
+					Found = Start + Entry.Length + Entry.Anchor;
+				}
+				else
+				{
+					++Found;
+				}
+			}
+		}
+
+		// Hold back the longest end of the stage that may be the start of a
+		// text, until the next chunk tells whether it is
+		HeldLength = 0;
+		for( std::size_t t = 0; t < TextCount; ++t )
+		{
+			const Text& Entry = Texts[t];
+			const std::size_t Longest = std::min(Entry.Length - 1, StageLength);
+			for( std::size_t Size = Longest; Size > HeldLength; --Size )
+			{
+				if( std::memcmp(
+					Stage + StageLength - Size, Entry.Bytes, Size
+				) == 0 )
+				{
+					HeldLength = Size;
+					break;
+				}
+			}
+		}
+		const std::size_t Ready = StageLength - HeldLength;
+		std::memcpy(Held, Stage + Ready, HeldLength);
+		Written += Base2::FilterDecode(Stage, Output + Written, Ready, Carry);
+	}
+	return Written;
+}
+
+std::size_t Base2::FormattedDecoder::Finish( std::uint8_t Output[] )
+{
+	const std::size_t Written
+		= Base2::FilterDecode(Held, Output, HeldLength, Carry);
+	HeldLength = 0;
+	Carry = {};
+	return Written;
+}
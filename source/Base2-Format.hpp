@@ -0,0 +1,161 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <algorithm>
+
+#include <Base2.hpp>
+
+#include "Base2-Kernels.hpp"
+
+// Formatted encoding that encodes into a staging block with `Encode` and then
+// writes the digits of each byte into a copy of the text around them. Every
+// tier shares the layout of the records, and may store them its own way.
+
+namespace
+{
+
+// Bytes of input encoded into a staging block at a time
+constexpr std::size_t FormatBlockSize = 512;
+
+using Base2::Kernels::FormatRecord;
+
+// Stores each record as a copy of its text followed by its digits. A tier may
+// store them its own way with a type of the same members, constructed once
+// for each call from the record that was laid out for the format.
+struct StoreRecordCopy
+{
+	const FormatRecord& Record;
+
+	explicit StoreRecordCopy( const FormatRecord& Record ) : Record(Record)
+	{
+	}
+
+	// Stores the records of the `Count` bytes whose digits are in `Digits`,
+	// when every byte is a group of its own, for as far as it is able to.
+	// Returns the number of records stored.
+	std::size_t StoreBlock(
+		char*, const char*, const std::uint64_t[], std::size_t
+	) const
+	{
+		return 0;
+	}
+
+	// `CopySize` bytes are stored, which may run past the end of the record
+	template<std::size_t CopySize>
+	void StoreRecord( char* Output, std::uint64_t Digits ) const
+	{
+		std::memcpy(Output, Record.Text, CopySize);
+		std::memcpy(Output + Record.DigitOffset, &Digits, 8);
+	}
+};
+
+// Writes the records of `Count` bytes whose digits are in `Digits`. Records
+// of `Size` bytes are stored with fixed-size stores as long as there is room
+// for them before `OutputEnd`, `0` stores records of any size.
+template<std::size_t Size, typename StoreT>
+char* StoreRecords(
+	char* Output, const char* OutputEnd, const std::uint64_t Digits[],
+	std::size_t Count, const StoreT& Store
+)
+{
+	const FormatRecord& Record = Store.Record;
+	constexpr std::size_t CopySize = Size == 0 ? 64 : Size <= 16 ? 16 : 64;
+	const std::size_t Stride = Size ? Size : Record.Size;
+	for( std::size_t i = 0; i < Count; ++i )
+	{
+		if( std::size_t(OutputEnd - Output) >= CopySize )
+		{
+			Store.template StoreRecord<CopySize>(Output, Digits[i]);
+		}
+		else
+		{
+			std::memcpy(Output, Record.Text, Stride);
+			std::memcpy(Output + Record.DigitOffset, &Digits[i], 8);
+		}
+		Output += Stride;
+	}
+	return Output;
+}
+
+// Writes the records of a run of bytes that are all within the same group,
+// specialized upon the sizes of records of up to a vector
+template<typename StoreT>
+char* StoreRun(
+	char* Output, const char* OutputEnd, const std::uint64_t Digits[],
+	std::size_t Count, const StoreT& Store
+)
+{
+	switch( Store.Record.Size )
+	{
+	case  8: return StoreRecords< 8, StoreT>(Output, OutputEnd, Digits, Count, Store);
+	case  9: return StoreRecords< 9, StoreT>(Output, OutputEnd, Digits, Count, Store);
+	case 10: return StoreRecords<10, StoreT>(Output, OutputEnd, Digits, Count, Store);
+	case 11: return StoreRecords<11, StoreT>(Output, OutputEnd, Digits, Count, Store);
+	case 12: return StoreRecords<12, StoreT>(Output, OutputEnd, Digits, Count, Store);
+	case 13: return StoreRecords<13, StoreT>(Output, OutputEnd, Digits, Count, Store);
+	case 14: return StoreRecords<14, StoreT>(Output, OutputEnd, Digits, Count, Store);
+	case 15: return StoreRecords<15, StoreT>(Output, OutputEnd, Digits, Count, Store);
+	case 16: return StoreRecords<16, StoreT>(Output, OutputEnd, Digits, Count, Store);
+	default: return StoreRecords< 0, StoreT>(Output, OutputEnd, Digits, Count, Store);
+	}
+}
+
+template<typename StoreT = StoreRecordCopy>
+inline std::size_t EncodeFormattedStaged(
+	Base2::Kernels::EncodeFunc Encode,
+	const std::uint8_t Input[], char Output[], std::size_t Length,
+	const FormatRecord& Record, std::uint64_t Position
+)
+{
+	const StoreT Store(Record);
+	const char* OutputStart = Output;
+	const char* OutputEnd = Output + Record.FormattedSize(Length, Position);
+	alignas(64) std::uint64_t Block[FormatBlockSize + 8];
+	std::size_t i = 0;
+	if( Length && Position == 0 && Record.Lead )
+	{
+		// The first byte of a stream has no separator before it
+		Encode(Input, Block, 1);
+		std::memcpy(Output, Record.Text + Record.Lead, Record.Size - Record.Lead);
+		std::memcpy(Output + Record.DigitOffset - Record.Lead, Block, 8);
+		Output += Record.Size - Record.Lead;
+		i = 1;
+		++Position;
+	}
+	for( ; i < Length; i += FormatBlockSize )
+	{
+		const std::size_t BlockLength = std::min(FormatBlockSize, Length - i);
+		Encode(Input + i, Block, BlockLength);
+		if( Record.GroupSize == 1 )
+		{
+			const std::size_t Stored = Store.StoreBlock(
+				Output, OutputEnd, Block, BlockLength
+			);
+			Output = StoreRun<StoreT>(
+				Output + Stored * Record.Size, OutputEnd, Block + Stored,
+				BlockLength - Stored, Store
+			);
+			Position += BlockLength;
+			continue;
+		}
+		for( std::size_t j = 0; j < BlockLength; )
+		{
+			const std::size_t GroupOffset = Position % Record.GroupSize;
+			if( Position && GroupOffset == 0 )
+			{
+				std::memcpy(Output, Record.Separator, Record.SeparatorSize);
+				Output += Record.SeparatorSize;
+			}
+			const std::size_t Run = std::min(
+				Record.GroupSize - GroupOffset, BlockLength - j
+			);
+			Output = StoreRun<StoreT>(Output, OutputEnd, Block + j, Run, Store);
+			j += Run;
+			Position += Run;
+		}
+	}
+	return Output - OutputStart;
+}
+
+}
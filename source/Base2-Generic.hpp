@@ -0,0 +1,182 @@
+/// Encoding
+
+namespace
+{
+
+void Encode(
+	const std::uint8_t Input[], std::uint64_t Output[], std::size_t Length
+)
+{
+	// Least significant bit in an 8-bit integer
+	constexpr std::uint64_t LSB8       = 0x0101010101010101UL;
+	// Each byte has a unique bit set
+	constexpr std::uint64_t UniqueBit  = 0x0102040810204080UL;
+	// Shifts unique bits to the left, using the carry of binary addition
+	constexpr std::uint64_t CarryShift = 0x7F7E7C7870604000UL;
+	// Most significant bit in an 8-bit integer
+	constexpr std::uint64_t MSB8       = LSB8 << 7u;
+	// Constant bits for ascii '0' and '1'
+	constexpr std::uint64_t BinAsciiBasis = LSB8 * '0';
+	for( std::size_t i = 0; i < Length; ++i )
+	{
+		Output[i] = ((((((
+			static_cast<std::uint64_t>(Input[i])
+			* LSB8			) // "broadcast" low byte to all 8 bytes.
+			& UniqueBit		) // Mask each byte to have 1 unique bit.
+			+ CarryShift	) // Shift this bit to the last bit of each
+							  // byte using the carry of binary addition.
+			& MSB8			) // Isolate these last bits of each byte.
+			>> 7			) // Shift it back to the low bit of each byte.
+			| BinAsciiBasis	  // Turn it into ascii '0' and '1'
+		);
+	}
+}
+
+}
+
+/// Line-wrapped encoding
+
+namespace
+{
+
+std::size_t EncodeWrapped(
+	const std::uint8_t Input[], char Output[], std::size_t Length,
+	std::size_t WrapWidth, std::size_t Column
+)
+{
+	return EncodeWrappedStaged(
+		::Encode, Input, Output, Length, WrapWidth, Column
+	);
+}
+
+}
+
+/// Formatted encoding
+
+namespace
+{
+
+std::size_t EncodeFormatted(
+	const std::uint8_t Input[], char Output[], std::size_t Length,
+	const FormatRecord& Record, std::uint64_t Position
+)
+{
+	return EncodeFormattedStaged(
+		::Encode, Input, Output, Length, Record, Position
+	);
+}
+
+}
+
+/// Decoding
+
+namespace
+{
+
+void Decode(
+	const std::uint64_t Input[], std::uint8_t Output[], std::size_t Length
+)
+{
+	for( std::size_t i = 0; i < Length; ++i )
+	{
+		std::uint8_t Binary = 0;
+		std::uint64_t Mask = 0x0101010101010101UL;
+		for( std::uint64_t CurBit = 1UL; Mask != 0; CurBit <<= 1 )
+		{
+			if( __builtin_bswap64(Input[i]) & Mask & -Mask )
+			{
+				Binary |= CurBit;
+			}
+			Mask &= (Mask - 1UL);
+		}
+		Output[i] = Binary;
+	}
+}
+
+}
+
+/// Validated decoding
+
+namespace
+{
+
+// Returns the offset of the first invalid byte, or `Length * 8`
+std::size_t DecodeChecked(
+	const std::uint64_t Input[], std::uint8_t Output[], std::size_t Length
+)
+{
+	for( std::size_t i = 0; i < Length; ++i )
+	{
+		if( (Input[i] & 0xFEFEFEFEFEFEFEFEUL) != 0x3030303030303030UL )
+		{
+			const std::uint8_t* ASCII
+				= reinterpret_cast<const std::uint8_t*>(Input + i);
+			std::size_t k = 0;
+			while( (ASCII[k] & 0xFE) == 0x30 ) ++k;
+			return i * 8 + k;
+		}
+		Decode(Input + i, Output + i, 1);
+	}
+	return Length * 8;
+}
+
+}
+
+/// Filtering
+
+namespace
+{
+
+std::size_t Filter(std::uint8_t Bytes[], std::size_t Length)
+{
+	std::size_t End = 0;
+	for( std::size_t i = 0; i < Length; ++i )
+	{
+		const std::uint8_t CurByte = Bytes[i];
+		if( (CurByte & 0b11111110) != 0x30 ) continue;
+		Bytes[End++] = CurByte;
+	}
+	return End;
+}
+
+}
+
+/// Fused filtering and decoding
+
+namespace
+{
+
+std::size_t FilterDecode(
+	const std::uint8_t Input[], std::uint8_t Output[], std::size_t Length,
+	Base2::DecodeCarry& Carry
+)
+{
+	return FilterDecodeStaged(
+		::Filter, ::Decode, Input, Output, Length, Carry
+	);
+}
+
+}
+
+/// Line-wrapped decoding
+
+namespace
+{
+
+std::size_t DecodeWrapped(
+	const std::uint8_t Input[], std::uint8_t Output[], std::size_t Length,
+	std::size_t WrapWidth, Base2::DecodeCarry& Carry
+)
+{
+	return DecodeWrappedStaged(
+		::DecodeChecked, ::FilterDecode, Input, Output, Length, WrapWidth, Carry
+	);
+}
+
+}
+
+const Base2::Kernels::Table Base2::Kernels::BASE2_TIER = {
+	::Encode, ::Decode, ::Filter, ::EncodeWrapped,
+	::FilterDecode, ::DecodeChecked, ::DecodeWrapped,
+	::Encode, ::EncodeFormatted
+};
@@ -0,0 +1,129 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+#include <Base2.hpp>
+
+// Every instruction-set tier of the library is compiled into its own
+// translation unit(see `Base2-Tier.cpp`) with the compiler flags of that tier
+// and exposes its kernels through a table of function pointers. The tier that
+// best fits the running processor is picked once at runtime by `Base2.cpp`.
+
+namespace Base2::Kernels
+{
+
+using EncodeFunc = void(*)(
+	const std::uint8_t Input[], std::uint64_t Output[], std::size_t Length
+);
+
+using DecodeFunc = void(*)(
+	const std::uint64_t Input[], std::uint8_t Output[], std::size_t Length
+);
+
+using DecodeCheckedFunc = std::size_t(*)(
+	const std::uint64_t Input[], std::uint8_t Output[], std::size_t Length
+);
+
+using DecodeWrappedFunc = std::size_t(*)(
+	const std::uint8_t Input[], std::uint8_t Output[], std::size_t Length,
+	std::size_t WrapWidth, Base2::DecodeCarry& Carry
+);
+
+using FilterFunc = std::size_t(*)(std::uint8_t Bytes[], std::size_t Length);
+
+using EncodeWrappedFunc = std::size_t(*)(
+	const std::uint8_t Input[], char Output[], std::size_t Length,
+	std::size_t WrapWidth, std::size_t Column
+);
+
+// Text that surrounds the digits of each byte of a format, with a slot for
+// the digits, laid out once by `Base2::FormattedEncoder`. When every byte is a
+// group of its own, the separator before each group leads the record, so that
+// every record is the same.
+struct FormatRecord
+{
+	// Text of a record with zeros in place of its digits, padded with zeros
+	alignas(64) std::uint8_t Text[64] = {};
+	std::size_t Size        = 0;
+	std::size_t DigitOffset = 0;
+	// Bytes of separator that lead the text
+	std::size_t Lead        = 0;
+	// Separator before every group of more than one byte
+	std::uint8_t Separator[Base2::MaxFormatText] = {};
+	std::size_t SeparatorSize = 0;
+	std::size_t GroupSize   = 1;
+
+	// When every byte is a group of its own, a 64-byte vector of records that
+	// starts `Phase` bytes into a record has the same text and digit slots as
+	// every other vector that does. For each `Phase`, the text of such a
+	// vector, a mask of its lanes that are digits, and the number of them.
+	alignas(64) std::uint8_t Templates[64][64] = {};
+	std::uint64_t Slots[64] = {};
+	std::uint8_t Taken[64]  = {};
+
+	explicit FormatRecord(const Base2::Format& Format);
+
+	// `Base2::FormattedSize` of the format
+	std::size_t FormattedSize(std::size_t Length, std::uint64_t Position) const;
+};
+
+using EncodeFormattedFunc = std::size_t(*)(
+	const std::uint8_t Input[], char Output[], std::size_t Length,
+	const FormatRecord& Record, std::uint64_t Position
+);
+
+using FilterDecodeFunc = std::size_t(*)(
+	const std::uint8_t Input[], std::uint8_t Output[], std::size_t Length,
+	Base2::DecodeCarry& Carry
+);
+
+struct Table
+{
+	EncodeFunc Encode;
+	DecodeFunc Decode;
+	FilterFunc Filter;
+	EncodeWrappedFunc EncodeWrapped;
+	FilterDecodeFunc  FilterDecode;
+	DecodeCheckedFunc DecodeChecked;
+	DecodeWrappedFunc DecodeWrapped;
+	// `Encode` with stores that bypass the cache, where the tier has them
+	EncodeFunc EncodeNonTemporal;
+	EncodeFormattedFunc EncodeFormatted;
+};
+
+#if defined(__x86_64__) || defined(_M_X64)
+// SSE2
+extern const Table Generic;
+// SSSE3 + SSE4.1
+extern const Table SSE41;
+// AVX2 + BMI2
+extern const Table AVX2;
+// AVX512F + AVX512BW + BMI2
+extern const Table AVX512BW;
+// AVX512F + AVX512BW + AVX512BITALG + AVX512VBMI2 + BMI2
+extern const Table AVX512BITALG;
+// SSSE3 + SSE4.1 + GFNI
+extern const Table SSE41GFNI;
+// AVX2 + BMI2 + GFNI
+extern const Table AVX2GFNI;
+// AVX512F + AVX512BW + BMI2 + GFNI
+extern const Table AVX512GFNI;
+#elif defined(__aarch64__) || defined(_M_ARM64)
+extern const Table NEON;
+#else
+// 64-bit SWAR
+extern const Table Generic;
+#endif
+
+struct Tier
+{
+	Base2::Isa Isa;
+	const char* Name;
+	const Table* Kernels;
+};
+
+// Tiers that the running processor supports, from narrowest to widest
+std::vector<Tier> SupportedTiers();
+
+}
@@ -0,0 +1,272 @@
+#include <Base2.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include "Base2-Kernels.hpp"
+#include "Base2-ThreadPool.hpp"
+
+namespace
+{
+// Bytes of input handed to a thread at a time. Its 8x larger output still
+// fits within the L2 cache of most processors.
+constexpr std::size_t EncodeChunkSize = 64 * 1024;
+// Bytes of ascii-binary input filtered by a thread at a time
+constexpr std::size_t FilterChunkSize = EncodeChunkSize * 8;
+}
+
+void Base2::ParallelEncode(
+	const std::uint8_t Input[], std::uint64_t Output[], std::size_t Length,
+	std::size_t ThreadCount
+)
+{
+	const std::size_t ChunkCount
+		= (Length + EncodeChunkSize - 1) / EncodeChunkSize;
+	if( ThreadCount == 1 || ChunkCount <= 1 )
+	{
+		Base2::Encode(Input, Output, Length);
+		return;
+	}
+	// Chunks bypass the cache when the output as a whole would
+	const bool NonTemporal = Length > Base2::NonTemporalThreshold() / 8;
+	// Each chunk of input maps to its own fixed range of output, so chunks
+	// may finish in any order and the output remains in order
+	ThreadPool::Get().ForEach(
+		ChunkCount, ThreadCount,
+		[=](std::size_t Chunk)
+		{
+			const std::size_t Offset = Chunk * EncodeChunkSize;
+			const std::size_t ChunkLength
+				= std::min(EncodeChunkSize, Length - Offset);
+			if( NonTemporal )
+			{
+				Base2::EncodeNonTemporal(
+					Input + Offset, Output + Offset, ChunkLength
+				);
+				return;
+			}
+			Base2::Encode(Input + Offset, Output + Offset, ChunkLength);
+		}
+	);
+}
+
+void Base2::ParallelDecode(
+	const std::uint64_t Input[], std::uint8_t Output[], std::size_t Length,
+	std::size_t ThreadCount
+)
+{
+	const std::size_t ChunkCount
+		= (Length + EncodeChunkSize - 1) / EncodeChunkSize;
+	if( ThreadCount == 1 || ChunkCount <= 1 )
+	{
+		Base2::Decode(Input, Output, Length);
+		return;
+	}
+	ThreadPool::Get().ForEach(
+		ChunkCount, ThreadCount,
+		[=](std::size_t Chunk)
+		{
+			const std::size_t Offset = Chunk * EncodeChunkSize;
+			Base2::Decode(
+				Input + Offset, Output + Offset,
+				std::min(EncodeChunkSize, Length - Offset)
+			);
+		}
+	);
+}
+
+std::size_t Base2::ParallelDecodeChecked(
+	const std::uint64_t Input[], std::uint8_t Output[], std::size_t Length,
+	std::size_t ThreadCount
+)
+{
+	const std::size_t ChunkCount
+		= (Length + EncodeChunkSize - 1) / EncodeChunkSize;
+	if( ThreadCount == 1 || ChunkCount <= 1 )
+	{
+		return Base2::DecodeChecked(Input, Output, Length);
+	}
+	// Offset of the first invalid byte of each chunk, if any
+	std::vector<std::size_t> Invalid(ChunkCount);
+	ThreadPool::Get().ForEach(
+		ChunkCount, ThreadCount,
+		[&](std::size_t Chunk)
+		{
+			const std::size_t Offset = Chunk * EncodeChunkSize;
+			const std::size_t ChunkLength
+				= std::min(EncodeChunkSize, Length - Offset);
+			const std::size_t ChunkInvalid = Base2::DecodeChecked(
+				Input + Offset, Output + Offset, ChunkLength
+			);
+			Invalid[Chunk] = ChunkInvalid == ChunkLength * 8 ?
+				Length * 8 : Offset * 8 + ChunkInvalid;
+		}
+	);
+	return *std::min_element(Invalid.begin(), Invalid.end());
+}
+
+std::size_t Base2::ParallelFilterDecode(
+	std::uint8_t Input[], std::uint8_t Output[], std::size_t Length,
+	std::size_t ThreadCount
+)
+{
+	const std::size_t ChunkCount
+		= (Length + FilterChunkSize - 1) / FilterChunkSize;
+	if( ChunkCount == 0 )
+	{
+		return 0;
+	}
+
+	// Filter each chunk in place, independently of the others
+	std::vector<std::size_t> DigitCounts(ChunkCount);
+	ThreadPool::Get().ForEach(
+		ChunkCount, ThreadCount,
+		[=, &DigitCounts](std::size_t Chunk)
+		{
+			const std::size_t Offset = Chunk * FilterChunkSize;
+			DigitCounts[Chunk] = Base2::Filter(
+				Input + Offset, std::min(FilterChunkSize, Length - Offset)
+			);
+		}
+	);
+
+	// An exclusive prefix-sum of the digit counts gives the position of each
+	// chunk's first digit within the stream of valid digits, and with it, the
+	// bit within an output byte that the chunk starts at
+	std::vector<std::size_t> DigitOffsets(ChunkCount + 1);
+	DigitOffsets[0] = 0;
+	for( std::size_t i = 0; i < ChunkCount; ++i )
+	{
+		DigitOffsets[i + 1] = DigitOffsets[i] + DigitCounts[i];
+	}
+	const std::size_t DigitTotal = DigitOffsets[ChunkCount];
+
+	// Digits of a chunk leading up to its first whole group of 8 digits
+	const auto HeadLength = [&](std::size_t Chunk) -> std::size_t
+	{
+		return std::min(
+			DigitCounts[Chunk], (8 - DigitOffsets[Chunk] % 8) % 8
+		);
+	};
+
+	// Decode the whole groups of 8 digits of each chunk into their position
+	// within the output
+	ThreadPool::Get().ForEach(
+		ChunkCount, ThreadCount,
+		[=, &DigitCounts, &DigitOffsets](std::size_t Chunk)
+		{
+			const std::size_t Head = HeadLength(Chunk);
+			Base2::Decode(
+				reinterpret_cast<const std::uint64_t*>(
+					Input + Chunk * FilterChunkSize + Head
+				),
+				Output + (DigitOffsets[Chunk] + Head) / 8,
+				(DigitCounts[Chunk] - Head) / 8
+			);
+		}
+	);
+
+	// Stitch together the groups of digits that straddle chunk boundaries,
+	// in order, from the digits before and after each chunk's whole groups
+	std::uint8_t Group[8];
+	std::size_t GroupLength = 0;
+	const auto Append = [&](
+		const std::uint8_t Digits[], std::size_t Count, std::size_t Position
+	)
+	{
+		for( std::size_t i = 0; i < Count; ++i )
+		{
+			Group[GroupLength++] = Digits[i];
+			if( GroupLength == 8 )
+			{
+				std::uint64_t GroupWord;
+				std::memcpy(&GroupWord, Group, 8);
+				Base2::Decode(&GroupWord, Output + (Position + i) / 8, 1);
+				GroupLength = 0;
+			}
+		}
+	};
+	for( std::size_t Chunk = 0; Chunk < ChunkCount; ++Chunk )
+	{
+		const std::uint8_t* Digits = Input + Chunk * FilterChunkSize;
+		const std::size_t Head = HeadLength(Chunk);
+		const std::size_t Whole = (DigitCounts[Chunk] - Head) / 8 * 8;
+		Append(Digits, Head, DigitOffsets[Chunk]);
+		Append(
+			Digits + Head + Whole, DigitCounts[Chunk] - Head - Whole,
+			DigitOffsets[Chunk] + Head + Whole
+		);
+	}
+
+	// Leave the digits of the final incomplete group at the front of the input
+	std::memcpy(Input, Group, GroupLength);
+	return DigitTotal;
+}
+
+std::size_t Base2::ParallelEncodeWrapped(
+	const std::uint8_t Input[], char Output[], std::size_t Length,
+	std::size_t WrapWidth, std::size_t Column, std::size_t ThreadCount
+)
+{
+	const std::size_t ChunkCount
+		= (Length + EncodeChunkSize - 1) / EncodeChunkSize;
+	if( ThreadCount == 1 || ChunkCount <= 1 )
+	{
+		return Base2::EncodeWrapped(Input, Output, Length, WrapWidth, Column);
+	}
+	// The column and output position that each chunk starts at only depends
+	// on the number of digits before it, so chunks are independent
+	ThreadPool::Get().ForEach(
+		ChunkCount, ThreadCount,
+		[=](std::size_t Chunk)
+		{
+			const std::size_t Offset = Chunk * EncodeChunkSize;
+			Base2::EncodeWrapped(
+				Input + Offset,
+				Output + Base2::WrappedSize(Offset, WrapWidth, Column),
+				std::min(EncodeChunkSize, Length - Offset), WrapWidth,
+				Base2::WrappedColumn(Offset, WrapWidth, Column)
+			);
+		}
+	);
+	return Base2::WrappedColumn(Length, WrapWidth, Column);
+}
+
+std::size_t Base2::FormattedEncoder::ParallelEncode(
+	const std::uint8_t Input[], char Output[], std::size_t Length,
+	std::uint64_t Position, std::size_t ThreadCount
+) const
+{
+	const std::size_t ChunkCount
+		= (Length + EncodeChunkSize - 1) / EncodeChunkSize;
+	if( ThreadCount == 1 || ChunkCount <= 1 )
+	{
+		return Encode(Input, Output, Length, Position);
+	}
+	// The separators before each chunk, and so where its output starts, only
+	// depend on its position within the stream
+	ThreadPool::Get().ForEach(
+		ChunkCount, ThreadCount,
+		[=](std::size_t Chunk)
+		{
+			const std::size_t Offset = Chunk * EncodeChunkSize;
+			Encode(
+				Input + Offset,
+				Output + Record->FormattedSize(Offset, Position),
+				std::min(EncodeChunkSize, Length - Offset), Position + Offset
+			);
+		}
+	);
+	return Record->FormattedSize(Length, Position);
+}
+
+std::size_t Base2::ParallelEncodeFormatted(
+	const std::uint8_t Input[], char Output[], std::size_t Length,
+	const Format& Format, std::uint64_t Position, std::size_t ThreadCount
+)
+{
+	return FormattedEncoder(Format).ParallelEncode(
+		Input, Output, Length, Position, ThreadCount
+	);
+}
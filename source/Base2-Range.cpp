@@ -0,0 +1,225 @@
+#include <Base2.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+namespace
+{
+inline bool IsDigit( std::uint8_t Byte )
+{
+	return (Byte & 0xFE) == 0x30;
+}
+
+std::uint64_t CountDigits( const std::uint8_t Input[], std::size_t Length )
+{
+	std::uint64_t Count = 0;
+	for( std::size_t i = 0; i < Length; ++i )
+	{
+		Count += IsDigit(Input[i]);
+	}
+	return Count;
+}
+
+// Offset of digit `Digit` within lines of `WrapWidth` digits, each followed by
+// a line ending of `EndingSize` bytes
+std::uint64_t DigitOffset(
+	std::uint64_t Digit, std::size_t WrapWidth, std::size_t EndingSize
+)
+{
+	if( WrapWidth == 0 )
+	{
+		return Digit;
+	}
+	return Digit + Digit / WrapWidth * EndingSize;
+}
+}
+
+std::uint64_t Base2::WrappedOffset(
+	std::uint64_t Offset, std::size_t WrapWidth, std::size_t EndingSize
+)
+{
+	return DigitOffset(Offset * 8, WrapWidth, EndingSize);
+}
+
+Base2::RangeDecoder::RangeDecoder(
+	const std::uint8_t Input[], std::size_t Length
+)
+	: Input(Input), Length(Length)
+{
+	Index.push_back({});
+
+	// The layout is taken from the first line, which is only searched for
+	// within the first stretch of the input. Longer lines are taken to be a
+	// single line, and the ranges that cross a line ending fall back to the
+	// index.
+	const void* LineEnd = std::memchr(
+		Input, '\n', std::min(Length, IndexSpacing)
+	);
+	if( LineEnd )
+	{
+		Width = static_cast<const std::uint8_t*>(LineEnd) - Input;
+		if( Width && Input[Width - 1] == '\r' )
+		{
+			--Width;
+			EndingSize = 2;
+		}
+		if( Width == 0 )
+		{
+			return;
+		}
+	}
+
+	// Every line but the last is full, and may be followed by a final line
+	// ending
+	std::size_t Content = Length;
+	if( Content && Input[Content - 1] == '\n' ) --Content;
+	if( Content && Input[Content - 1] == '\r' ) --Content;
+	std::uint64_t Digits = Content;
+	if( Width )
+	{
+		const std::size_t LastLine = Content % (Width + EndingSize);
+		if( LastLine == 0 || LastLine > Width )
+		{
+			return;
+		}
+		Digits = Content / (Width + EndingSize) * Width + LastLine;
+	}
+	Size = Digits / 8;
+	IsRegular = true;
+}
+
+std::size_t Base2::RangeDecoder::WrapWidth() const
+{
+	return Width;
+}
+
+bool Base2::RangeDecoder::Regular() const
+{
+	return IsRegular;
+}
+
+std::size_t Base2::RangeDecoder::Decode(
+	std::uint64_t Offset, std::size_t Length, std::uint8_t Output[]
+)
+{
+	if( IsRegular )
+	{
+		if( Offset >= Size )
+		{
+			return 0;
+		}
+		Length = std::min<std::uint64_t>(Length, Size - Offset);
+		if( Length == 0 )
+		{
+			return 0;
+		}
+		const std::size_t Column = Width ? Offset * 8 % Width : 0;
+		const std::size_t Start = DigitOffset(Offset * 8, Width, EndingSize);
+		const std::size_t End
+			= DigitOffset((Offset + Length) * 8 - 1, Width, EndingSize) + 1;
+		// The range agrees with the layout when the byte before it and the line
+		// endings of every line that it is within are where the layout expects
+		// them, and its digits end where the layout expects them to
+		bool Agrees = Start == 0 || (
+			Width && Column == 0 ?
+				Input[Start - 1] == '\n' : IsDigit(Input[Start - 1])
+		);
+		if( Width )
+		{
+			const std::uint64_t RangeEnd = (Offset + Length) * 8;
+			for(
+				std::uint64_t Digit = std::max<std::uint64_t>(
+					Offset * 8 / Width * Width, Width
+				);
+				Agrees && Digit < RangeEnd + Width; Digit += Width
+			)
+			{
+				const std::uint64_t Ending = DigitOffset(Digit, Width, EndingSize) - 1;
+				if( Ending >= this->Length ) break;
+				Agrees = Input[Ending] == '\n';
+			}
+		}
+		if( Agrees )
+		{
+			std::size_t Position = Start;
+			const std::size_t Written = DecodeFrom(Position, Column, Length, Output);
+			if( Written == Length && Position == End )
+			{
+				return Written;
+			}
+		}
+		IsRegular = false;
+	}
+
+	std::size_t Position = Locate(Offset * 8);
+	const std::size_t Written = DecodeFrom(Position, 0, Length, Output);
+	if( Written == Length )
+	{
+		Cursor = {Position, (Offset + Written) * 8};
+	}
+	return Written;
+}
+
+std::size_t Base2::RangeDecoder::Locate( std::uint64_t Digit )
+{
+	while( Index.back().Digits <= Digit && Index.back().Position < Length )
+	{
+		Checkpoint Next = Index.back();
+		const std::size_t Span = std::min(IndexSpacing, Length - Next.Position);
+		Next.Digits += CountDigits(Input + Next.Position, Span);
+		Next.Position += Span;
+		Index.push_back(Next);
+	}
+
+	// Count the digits from the closest position before the digit, which is
+	// either within the index or where the last range ended
+	Checkpoint From = *std::prev(
+		std::upper_bound(
+			Index.begin(), Index.end(), Digit,
+			[]( std::uint64_t Digit, const Checkpoint& Point )
+			{
+				return Digit < Point.Digits;
+			}
+		)
+	);
+	if( Cursor.Digits <= Digit && Cursor.Position > From.Position )
+	{
+		From = Cursor;
+	}
+	std::size_t Position = From.Position;
+	for( std::uint64_t Digits = From.Digits; Position < Length; ++Position )
+	{
+		if( IsDigit(Input[Position]) && Digits++ == Digit )
+		{
+			break;
+		}
+	}
+	return Position;
+}
+
+std::size_t Base2::RangeDecoder::DecodeFrom(
+	std::size_t& Position, std::size_t Column, std::size_t Length,
+	std::uint8_t Output[]
+)
+{
+	DecodeCarry Carry;
+	Carry.Column = Column;
+	std::size_t Written = 0;
+	while( Written < Length && Position < this->Length )
+	{
+		// Never more bytes of input than there are digits left in the range,
+		// so that no more than `Length` bytes are written
+		const std::size_t Room = std::min<std::size_t>(
+			Length - Written, SIZE_MAX / 8
+		);
+		const std::size_t Chunk = std::min(
+			this->Length - Position, Room * 8 - Carry.Count
+		);
+		Written += Base2::DecodeWrapped(
+			Input + Position, Output + Written, Chunk, IsRegular ? Width : 0, Carry
+		);
+		Position += Chunk;
+	}
+	return Written;
+}
@@ -0,0 +1,53 @@
+#include <Base2.hpp>
+
+/// StreamEncoder
+
+Base2::StreamEncoder::StreamEncoder( std::size_t WrapWidth )
+	: WrapWidth(WrapWidth)
+{
+}
+
+std::size_t Base2::StreamEncoder::OutputSize( std::size_t Length ) const
+{
+	return Base2::WrappedSize(Length, WrapWidth, Column);
+}
+
+std::size_t Base2::StreamEncoder::Update(
+	const std::uint8_t Input[], std::size_t Length, char Output[]
+)
+{
+	const std::size_t Written = OutputSize(Length);
+	Column = Base2::EncodeWrapped(Input, Output, Length, WrapWidth, Column);
+	return Written;
+}
+
+void Base2::StreamEncoder::Reset()
+{
+	Column = 0;
+}
+
+/// StreamDecoder
+
+Base2::StreamDecoder::StreamDecoder( std::size_t WrapWidth )
+	: WrapWidth(WrapWidth)
+{
+}
+
+std::size_t Base2::StreamDecoder::MaxOutputSize( std::size_t Length ) const
+{
+	return (Carry.Count + Length) / 8;
+}
+
+std::size_t Base2::StreamDecoder::Update(
+	const std::uint8_t Input[], std::size_t Length, std::uint8_t Output[]
+)
+{
+	return Base2::DecodeWrapped(Input, Output, Length, WrapWidth, Carry);
+}
+
+std::size_t Base2::StreamDecoder::Finish()
+{
+	const std::size_t Discarded = Carry.Count;
+	Carry = {};
+	return Discarded;
+}
@@ -0,0 +1,105 @@
+#include "Base2-ThreadPool.hpp"
+
+#include <algorithm>
+
+Base2::ThreadPool& Base2::ThreadPool::Get()
+{
+	static ThreadPool Pool;
+	return Pool;
+}
+
+Base2::ThreadPool::~ThreadPool()
+{
+	{
+		const std::lock_guard<std::mutex> Guard(StateLock);
+		Stopping = true;
+	}
+	Wake.notify_all();
+	for( std::thread& Worker : Workers )
+	{
+		Worker.join();
+	}
+}
+
+std::size_t Base2::ThreadPool::DefaultThreadCount()
+{
+	return std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+}
+
+void Base2::ThreadPool::ForEach(
+	std::size_t TaskCount, std::size_t ThreadCount,
+	const std::function<void(std::size_t)>& Task
+)
+{
+	if( ThreadCount == 0 )
+	{
+		ThreadCount = DefaultThreadCount();
+	}
+	ThreadCount = std::min(ThreadCount, TaskCount);
+
+	std::unique_lock<std::mutex> Job(JobLock, std::try_to_lock);
+	if( ThreadCount <= 1 || !Job.owns_lock() )
+	{
+		for( std::size_t i = 0; i < TaskCount; ++i )
+		{
+			Task(i);
+		}
+		return;
+	}
+
+	{
+		const std::lock_guard<std::mutex> Guard(StateLock);
+		while( Workers.size() < ThreadCount - 1 )
+		{
+			Workers.emplace_back(&ThreadPool::WorkerMain, this);
+		}
+		CurTask             = &Task;
+		this->TaskCount     = TaskCount;
+		NextTask.store(0, std::memory_order_relaxed);
+		HelpersWanted       = ThreadCount - 1;
+	}
+	Wake.notify_all();
+
+	Drain();
+
+	std::unique_lock<std::mutex> State(StateLock);
+	// Workers that have not picked up this job by now are no longer needed
+	HelpersWanted = 0;
+	Done.wait(State, [this]{ return HelpersBusy == 0; });
+	CurTask = nullptr;
+}
+
+void Base2::ThreadPool::WorkerMain()
+{
+	std::unique_lock<std::mutex> State(StateLock);
+	while( true )
+	{
+		Wake.wait(State, [this]{ return Stopping || HelpersWanted > 0; });
+		if( Stopping )
+		{
+			return;
+		}
+		--HelpersWanted;
+		++HelpersBusy;
+
+		State.unlock();
+		Drain();
+		State.lock();
+
+		if( --HelpersBusy == 0 )
+		{
+			Done.notify_all();
+		}
+	}
+}
+
+void Base2::ThreadPool::Drain()
+{
+	for(
+		std::size_t i = NextTask.fetch_add(1, std::memory_order_relaxed);
+		i < TaskCount; i = NextTask.fetch_add(1, std::memory_order_relaxed)
+	)
+	{
+		(*CurTask)(i);
+	}
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include <cstddef>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Base2
+{
+
+// A persistent set of worker threads that cooperatively drain a range of task
+// indices. Every participating thread, including the caller, claims the next
+// unclaimed index from a shared cursor, so threads that finish their tasks
+// early keep taking work that would otherwise wait on slower threads.
+class ThreadPool
+{
+public:
+	// Process-wide pool, started upon first use
+	static ThreadPool& Get();
+
+	ThreadPool() = default;
+	~ThreadPool();
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	// Calls `Task(i)` for each `i` in [0, TaskCount) using up to `ThreadCount`
+	// threads, including the calling thread, and returns once all tasks are
+	// complete. If the pool is already busy with another call then the tasks
+	// are run serially on the calling thread instead.
+	void ForEach(
+		std::size_t TaskCount, std::size_t ThreadCount,
+		const std::function<void(std::size_t)>& Task
+	);
+
+	// Number of threads to use when a caller asks for `0`(automatic) threads
+	static std::size_t DefaultThreadCount();
+
+private:
+	void WorkerMain();
+	void Drain();
+
+	// Serializes calls to `ForEach`
+	std::mutex JobLock;
+
+	std::mutex StateLock;
+	std::condition_variable Wake;
+	std::condition_variable Done;
+	std::vector<std::thread> Workers;
+	bool Stopping = false;
+
+	// Current job
+	const std::function<void(std::size_t)>* CurTask = nullptr;
+	std::size_t TaskCount = 0;
+	std::atomic<std::size_t> NextTask{0};
+	std::size_t HelpersWanted = 0;
+	std::size_t HelpersBusy = 0;
+};
+
+}
@@ -0,0 +1,17 @@
+// Compiled once per instruction-set tier, with `BASE2_TIER` naming the tier
+// and the compiler flags of that tier enabling its kernels
+#include <cstdint>
+#include <cstddef>
+
+#include "Base2-Kernels.hpp"
+#include "Base2-Wrap.hpp"
+#include "Base2-Format.hpp"
+#include "Base2-FilterDecode.hpp"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include "Base2-x86.hpp"
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#include "Base2-arm64.hpp"
+#else
+#include "Base2-Generic.hpp"
+#endif
@@ -0,0 +1,204 @@
+#include <Base2.hpp>
+
+#include <algorithm>
+#include <cstring>
+
+std::size_t Base2::WrappedColumn(
+	std::size_t Length, std::size_t WrapWidth, std::size_t Column
+)
+{
+	if( WrapWidth == 0 || Length == 0 )
+	{
+		return Column;
+	}
+	return (Column + Length * 8 - 1) % WrapWidth + 1;
+}
+
+std::size_t Base2::WrappedSize(
+	std::size_t Length, std::size_t WrapWidth, std::size_t Column
+)
+{
+	if( WrapWidth == 0 || Length == 0 )
+	{
+		return Length * 8;
+	}
+	// A newline is placed before each digit that would go past `WrapWidth`
+	return Length * 8 + (Column + Length * 8 - 1) / WrapWidth;
+}
+
+/// CheckedWrapDecoder
+
+Base2::CheckedWrapDecoder::CheckedWrapDecoder(
+	std::size_t WrapWidth, std::size_t ThreadCount
+)
+	: WrapWidth(WrapWidth), ThreadCount(ThreadCount)
+{
+}
+
+std::size_t Base2::CheckedWrapDecoder::MaxOutputSize( std::size_t Length ) const
+{
+	return (Carried + Length) / 8;
+}
+
+std::size_t Base2::CheckedWrapDecoder::Update(
+	const std::uint8_t Input[], std::size_t Length, std::uint8_t Output[]
+)
+{
+	if( Invalid )
+	{
+		return 0;
+	}
+	// Room for every digit of the chunk after those carried over, padded to
+	// whole groups
+	Block.resize((Carried + Length) / 8 + 2);
+	std::uint8_t* Stage = reinterpret_cast<std::uint8_t*>(Block.data());
+	std::size_t Staged = Carried;
+	Spans.clear();
+	// Offset and value of a byte that breaks the layout
+	bool Broken = false;
+	std::uint64_t BrokenOffset = 0;
+	std::uint8_t BrokenByte = 0;
+	for( std::size_t j = 0; j < Length && !Broken; )
+	{
+		if( Ended || (PendingLF && Input[j] != '\n') )
+		{
+			// Only the last line may be shorter, and a `\r` may not be on its
+			// own
+			Broken = true;
+			BrokenOffset = EndedOffset;
+			BrokenByte = EndedByte;
+			break;
+		}
+		if( PendingLF )
+		{
+			Ended = Column < WrapWidth;
+			Column = 0;
+			PendingLF = false;
+			++j;
+			continue;
+		}
+		if( Column == WrapWidth )
+		{
+			if( Input[j] != '\n' && Input[j] != '\r' )
+			{
+				Broken = true;
+				BrokenOffset = InputOffset + j;
+				BrokenByte = Input[j];
+				break;
+			}
+			PendingLF = Input[j] == '\r';
+			if( PendingLF )
+			{
+				EndedOffset = InputOffset + j;
+				EndedByte = Input[j];
+			}
+			else
+			{
+				Column = 0;
+			}
+			++j;
+			continue;
+		}
+		// Digits up until the end of the line, or an ending that cuts it short
+		std::size_t Span = std::min(WrapWidth - Column, Length - j);
+		const void* LineEnd = std::memchr(Input + j, '\n', Span);
+		std::size_t Ending = 0;
+		if( LineEnd )
+		{
+			Span = static_cast<const std::uint8_t*>(LineEnd) - (Input + j);
+			Ending = 1;
+			if( Span && Input[j + Span - 1] == '\r' )
+			{
+				--Span;
+				++Ending;
+			}
+		}
+		else if( j + Span == Length && Input[Length - 1] == '\r' )
+		{
+			// The `\n` of a `\r\n` may be in the next chunk
+			--Span;
+		}
+		Spans.push_back({Staged, j});
+		std::memcpy(Stage + Staged, Input + j, Span);
+		Staged += Span;
+		Column += Span;
+		j += Span;
+		if( Ending )
+		{
+			EndedOffset = InputOffset + j;
+			EndedByte = Input[j];
+			Ended = true;
+			Column = 0;
+			j += Ending;
+		}
+		else if( j + 1 == Length && Input[j] == '\r' )
+		{
+			EndedOffset = InputOffset + j;
+			EndedByte = Input[j];
+			PendingLF = true;
+			++j;
+		}
+	}
+
+	// Digits that were carried over were already validated
+	const std::size_t Groups = Staged / 8;
+	std::size_t Valid = Base2::ParallelDecodeChecked(
+		Block.data(), Output, Groups, ThreadCount
+	);
+	if( Valid == Groups * 8 )
+	{
+		while( Valid < Staged && (Stage[Valid] & 0xFE) == 0x30 ) ++Valid;
+	}
+	if( Valid < Staged )
+	{
+		// The first invalid digit comes before any break in the layout
+		const Span& Source = *std::prev(std::upper_bound(
+			Spans.begin(), Spans.end(), Valid,
+			[]( std::size_t Index, const Span& Entry )
+			{
+				return Index < Entry.Staged;
+			}
+		));
+		Invalid = true;
+		InvalidOffset = InputOffset + Source.Input + (Valid - Source.Staged);
+		InvalidByte = Stage[Valid];
+		return Valid / 8;
+	}
+	if( Broken )
+	{
+		Invalid = true;
+		InvalidOffset = BrokenOffset;
+		InvalidByte = BrokenByte;
+		return Groups;
+	}
+	Carried = Staged % 8;
+	std::memmove(Stage, Stage + Groups * 8, Carried);
+	InputOffset += Length;
+	return Groups;
+}
+
+std::size_t Base2::CheckedWrapDecoder::Finish()
+{
+	if( PendingLF && !Invalid )
+	{
+		Invalid = true;
+		InvalidOffset = EndedOffset;
+		InvalidByte = EndedByte;
+	}
+	return Invalid ? 0 : Carried;
+}
+
+bool Base2::CheckedWrapDecoder::Failed() const
+{
+	return Invalid;
+}
+
+std::uint64_t Base2::CheckedWrapDecoder::FailedOffset() const
+{
+	return InvalidOffset;
+}
+
+std::uint8_t Base2::CheckedWrapDecoder::FailedByte() const
+{
+	return InvalidByte;
+}
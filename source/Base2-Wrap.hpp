@@ -0,0 +1,253 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <algorithm>
+
+#include <Base2.hpp>
+
+#include "Base2-Kernels.hpp"
+
+// Line-wrapped encoding that encodes into a staging block with `Encode` and
+// then copies the digits into the output a line at a time. Shared by every
+// tier for the widths and tails that its own wrapped kernel does not handle.
+
+namespace
+{
+
+// Bytes of input encoded into a staging block at a time. The block stays
+// within the L1 cache, so the only trip to memory is the final store into the
+// wrapped output.
+constexpr std::size_t WrapBlockSize = 512;
+
+inline std::size_t EncodeWrappedStaged(
+	Base2::Kernels::EncodeFunc Encode,
+	const std::uint8_t Input[], char Output[], std::size_t Length,
+	std::size_t WrapWidth, std::size_t Column
+)
+{
+	if( WrapWidth == 0 )
+	{
+		Encode(Input, reinterpret_cast<std::uint64_t*>(Output), Length);
+		return Column;
+	}
+
+	// Spans of up to 64 digits are copied as a fixed 64 bytes that may run
+	// past the end of the span, which is then overwritten by the bytes after
+	// it. The block is padded so that these copies never read past it, and
+	// the final spans near the end of the output are copied exactly.
+	alignas(64) std::uint64_t Block[WrapBlockSize + 8];
+	const char* OutputEnd
+		= Output + Base2::WrappedSize(Length, WrapWidth, Column);
+	for( std::size_t i = 0; i < Length; i += WrapBlockSize )
+	{
+		const std::size_t BlockLength = std::min(WrapBlockSize, Length - i);
+		Encode(Input + i, Block, BlockLength);
+
+		const char* Digits = reinterpret_cast<const char*>(Block);
+		const char* DigitsEnd = Digits + BlockLength * 8;
+		while( Digits < DigitsEnd )
+		{
+			if( Column == WrapWidth )
+			{
+				*Output++ = '\n';
+				Column = 0;
+			}
+			const std::size_t Span = std::min<std::size_t>(
+				WrapWidth - Column, DigitsEnd - Digits
+			);
+			if( Span <= 64 && std::size_t(OutputEnd - Output) >= 64 )
+			{
+				std::memcpy(Output, Digits, 64);
+			}
+			else
+			{
+				std::memcpy(Output, Digits, Span);
+			}
+			Output += Span;
+			Digits += Span;
+			Column += Span;
+		}
+	}
+	return Column;
+}
+
+}
+
+// Garbage-tolerant decoding of line-wrapped input, staging the digits of the
+// lines that match the layout into a block that is then decoded at once
+
+namespace
+{
+
+// Digits staged from the lines of the input at a time, to be decoded at once
+constexpr std::size_t DecodeBlockSize = 4096;
+
+// Column of a line that has not yet been found to match the layout, until
+// the start of the next line
+constexpr std::size_t UnknownColumn = ~std::size_t(0);
+
+// Copies a span of digits from within a line. Spans are copied as fixed-size
+// 64-byte copies, which may overlap one another for spans of up to 128
+// digits, or run past the end of a shorter span when there is room to.
+inline void CopySpan(
+	std::uint8_t* Output, const std::uint8_t* Input, std::size_t Span,
+	std::size_t InputRoom
+)
+{
+	if( Span >= 64 && Span <= 128 )
+	{
+		std::memcpy(Output, Input, 64);
+		std::memcpy(Output + Span - 64, Input + Span - 64, 64);
+	}
+	else if( Span < 64 && InputRoom >= 64 )
+	{
+		std::memcpy(Output, Input, 64);
+	}
+	else
+	{
+		std::memcpy(Output, Input, Span);
+	}
+}
+
+inline std::size_t DecodeWrappedStaged(
+	Base2::Kernels::DecodeCheckedFunc DecodeChecked,
+	Base2::Kernels::FilterDecodeFunc FilterDecode,
+	const std::uint8_t Input[], std::uint8_t Output[], std::size_t Length,
+	std::size_t WrapWidth, Base2::DecodeCarry& Carry
+)
+{
+	if( WrapWidth == 0 )
+	{
+		return FilterDecode(Input, Output, Length, Carry);
+	}
+
+	// Room for spans that are copied past the end of the block
+	alignas(64) std::uint8_t Block[DecodeBlockSize + 64];
+	const std::uint8_t* OutputStart = Output;
+	std::size_t i = 0;
+	while( i < Length )
+	{
+		// Filter the rest of an irregular line and pick the layout back up at
+		// the start of the next one
+		if( Carry.Column > WrapWidth )
+		{
+			const void* LineEnd = std::memchr(Input + i, '\n', Length - i);
+			const std::size_t End = LineEnd ?
+				static_cast<const std::uint8_t*>(LineEnd) - Input + 1 : Length;
+			Output += FilterDecode(Input + i, Output, End - i, Carry);
+			if( LineEnd )
+			{
+				Carry.Column = 0;
+			}
+			i = End;
+			continue;
+		}
+
+		// Stage the digits of each line, skipping the line ending expected
+		// after every `WrapWidth` digits
+		for( std::size_t k = 0; k < Carry.Count; ++k )
+		{
+			Block[k] = '0' + ((Carry.Digits >> k) & 1);
+		}
+		std::size_t Staged = Carry.Count;
+		std::size_t Column = Carry.Column;
+		std::size_t j = i;
+		bool Regular = true;
+		while( j < Length && Staged < DecodeBlockSize )
+		{
+			// Whole lines, while the input and the block have room for them
+			if( Column == 0 )
+			{
+				while(
+					j + WrapWidth + 2 <= Length
+					&& Staged + WrapWidth <= DecodeBlockSize
+				)
+				{
+					const std::uint8_t* LineEnd = Input + j + WrapWidth;
+					std::size_t EndingSize = 0;
+					if( LineEnd[0] == '\n' )
+					{
+						EndingSize = 1;
+					}
+					else if( LineEnd[0] == '\r' && LineEnd[1] == '\n' )
+					{
+						EndingSize = 2;
+					}
+					else break;
+					CopySpan(Block + Staged, Input + j, WrapWidth, Length - j);
+					Staged += WrapWidth;
+					j += WrapWidth + EndingSize;
+				}
+			}
+			if( Column == WrapWidth )
+			{
+				if( Input[j] == '\n' )
+				{
+					++j;
+					Column = 0;
+					continue;
+				}
+				// The `\n` of a `\r\n` may be in the next call
+				if(
+					Input[j] == '\r'
+					&& (j + 1 == Length || Input[j + 1] == '\n')
+				)
+				{
+					++j;
+					continue;
+				}
+				Regular = false;
+				break;
+			}
+			std::size_t Span = std::min(
+				{WrapWidth - Column, Length - j, DecodeBlockSize - Staged}
+			);
+			// A line that ends early, such as the last one, ends the block
+			// before its line ending, which is then filtered on its own
+			const void* LineEnd = std::memchr(Input + j, '\n', Span);
+			if( LineEnd )
+			{
+				Span = static_cast<const std::uint8_t*>(LineEnd) - (Input + j);
+				if( Span && Input[j + Span - 1] == '\r' ) --Span;
+			}
+			CopySpan(Block + Staged, Input + j, Span, Length - j);
+			Staged += Span;
+			Column += Span;
+			j += Span;
+			if( LineEnd )
+			{
+				Regular = false;
+				break;
+			}
+		}
+
+		// Decode the staged digits, as long as they are all digits
+		const std::size_t Groups = Staged / 8;
+		std::size_t Valid = DecodeChecked(
+			reinterpret_cast<const std::uint64_t*>(Block), Output, Groups
+		);
+		while( Valid < Staged && (Block[Valid] & 0xFE) == 0x30 ) ++Valid;
+		if( Valid == Staged )
+		{
+			Output += Groups;
+			Carry.Count = Staged % 8;
+			Carry.Digits = 0;
+			for( std::size_t k = 0; k < Carry.Count; ++k )
+			{
+				Carry.Digits |= (Block[Groups * 8 + k] & 1) << k;
+			}
+			Carry.Column = Regular ? Column : UnknownColumn;
+		}
+		else
+		{
+			// A line has garbage within its digits
+			Output += FilterDecode(Input + i, Output, j - i, Carry);
+			Carry.Column = UnknownColumn;
+		}
+		i = j;
+	}
+	return Output - OutputStart;
+}
+
+}
@@ -49,7 +49,7 @@ inline void Encode<1>(
 		0, 1, 2, 3, 4, 5, 6, 7, 0, 1, 2, 3, 4, 5, 6, 7
 	};
 	std::size_t i = 0;
-	for( ; i < Length; i += 2 )
+	for( ; i + 1 < Length; i += 2 )
 	{
 		const uint8x8x2_t Input2 = vld2_dup_u8(Input + i);
 		// Broadcast byte across 8 byte lanes
@@ -62,7 +62,7 @@ inline void Encode<1>(
 		vst1q_u64(Output + i, vreinterpretq_u64_u8(Word2));
 	}
 
-	Encode<0>(Input + i * 2, Output + i * 2, Length % 2);
+	Encode<0>(Input + i, Output + i, Length % 2);
 }
 
 // Four at a time
@@ -78,7 +78,7 @@ inline void Encode<2>(
 		0, 1, 2, 3, 4, 5, 6, 7
 	};
 	std::size_t i = 0;
-	for( ; i < Length; i += 4 )
+	for( ; i + 3 < Length; i += 4 )
 	{
 		const uint8x8x4_t Input4 = vld4_dup_u8(Input + i);
 		// Broadcast byte across 8 byte lanes
@@ -98,19 +98,88 @@ inline void Encode<2>(
 		vst1q_u64(Output + i + 2, vreinterpretq_u64_u8(Word4.val[1]));
 	}
 
-	Encode<1>(Input + i * 4, Output + i * 4, Length % 4);
+	Encode<1>(Input + i, Output + i, Length % 4);
 }
 
+// Eight at a time
+template<>
+inline void Encode<3>(
+	const std::uint8_t Input[], std::uint64_t Output[], std::size_t Length
+)
+{
+	// Constant bits for ascii '0' and '1'
+	const uint8x16_t BinAsciiBasis = vdupq_n_u8('0');
+	// Selects each bit, most significant first
+	const uint8x16_t UniqueBit = {
+		128, 64, 32, 16, 8, 4, 2, 1,
+		128, 64, 32, 16, 8, 4, 2, 1
+	};
+	// Broadcasts two of the eight input bytes across 8 byte lanes each
+	const uint8x16_t Broadcast[4] = {
+		{ 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1 },
+		{ 2, 2, 2, 2, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 3, 3 },
+		{ 4, 4, 4, 4, 4, 4, 4, 4, 5, 5, 5, 5, 5, 5, 5, 5 },
+		{ 6, 6, 6, 6, 6, 6, 6, 6, 7, 7, 7, 7, 7, 7, 7, 7 }
+	};
+	std::size_t i = 0;
+	for( ; i + 7 < Length; i += 8 )
+	{
+		const uint8x8_t Input8 = vld1_u8(Input + i);
+		const uint8x16_t Table = vcombine_u8(Input8, Input8);
+		uint8x16x4_t Word8;
+		for( std::size_t k = 0; k < 4; ++k )
+		{
+			// Broadcast byte across 8 byte lanes
+			Word8.val[k] = vqtbl1q_u8(Table, Broadcast[k]);
+			// Set lanes to 0xFF(-1) where their unique bit is set
+			Word8.val[k] = vtstq_u8(Word8.val[k], UniqueBit);
+			// '0' - (-1) = '1'
+			Word8.val[k] = vsubq_u8(BinAsciiBasis, Word8.val[k]);
+		}
+		// Store
+		vst1q_u8_x4(reinterpret_cast<std::uint8_t*>(Output + i), Word8);
+	}
+
+	Encode<2>(Input + i, Output + i, Length % 8);
 }
 
+}
 
-void Base2::Encode(
-	const std::uint8_t Input[], std::uint64_t Output[], std::size_t Length
+
+
+/// Line-wrapped encoding
+
+namespace
+{
+
+std::size_t EncodeWrapped(
+	const std::uint8_t Input[], char Output[], std::size_t Length,
+	std::size_t WrapWidth, std::size_t Column
+)
+{
+	return EncodeWrappedStaged(
+		::Encode<0xFFu>, Input, Output, Length, WrapWidth, Column
+	);
+}
+
+}
+
+/// Formatted encoding
+
+namespace
+{
+
+std::size_t EncodeFormatted(
+	const std::uint8_t Input[], char Output[], std::size_t Length,
+	const FormatRecord& Record, std::uint64_t Position
 )
 {
-	::Encode<0xFFu>(Input, Output, Length);
+	return EncodeFormattedStaged(
+		::Encode<0xFFu>, Input, Output, Length, Record, Position
+	);
 }
 
+}
 
 /// Decoding
 
@@ -150,80 +219,232 @@ inline void Decode<0>(
 }
 
 // Two at a time
+// Decodes 16 ascii-bytes into two bytes
+inline void Decode2( uint8x16_t ASCII, std::uint8_t Output[] )
+{
+	const int8x16_t Shift = {
+		0, -1, -2, -3, -4, -5, -6, -7, 0, -1, -2, -3, -4, -5, -6, -7
+	};
+	// Push each of the low bits to the high bit
+	ASCII = vshlq_n_u8(ASCII, 7);
+	// Shift each bit into a unique position
+	ASCII = vshlq_u8(ASCII, Shift);
+	// Horizontally reduce bytes, using "add" as "or" since each bit is
+	// uniquely positioned
+	Output[0] = vaddv_u8(vget_low_u8(ASCII));
+	Output[1] = vaddv_u8(vget_high_u8(ASCII));
+}
+
 template<>
 inline void Decode<1>(
 	const std::uint64_t Input[], std::uint8_t Output[], std::size_t Length
 )
+{
+	std::size_t i = 0;
+	for( ; i + 1 < Length; i += 2 )
+	{
+		Decode2(
+			vld1q_u8(reinterpret_cast<const std::uint8_t*>(Input + i)),
+			Output + i
+		);
+	}
+
+	Decode<0>(Input + i, Output + i, Length % 2);
+}
+
+// Moves the low bit of each ascii-byte into its unique position within its
+// 8-byte lane, so that summing the lane produces the decoded byte
+inline uint8x16_t DecodeBits( uint8x16_t ASCII )
 {
 	const int8x16_t Shift = {
 		0, -1, -2, -3, -4, -5, -6, -7, 0, -1, -2, -3, -4, -5, -6, -7
 	};
+	return vshlq_u8(vshlq_n_u8(ASCII, 7), Shift);
+}
+
+// Four at a time
+template<>
+inline void Decode<2>(
+	const std::uint64_t Input[], std::uint8_t Output[], std::size_t Length
+)
+{
 	std::size_t i = 0;
-	for(; i < Length; i += 2 )
+	for( ; i + 3 < Length; i += 4 )
 	{
-		uint8x16_t ASCII = vld1q_u8(
+		const uint8x16x2_t ASCII = vld1q_u8_x2(
 			reinterpret_cast<const std::uint8_t*>(Input + i)
 		);
-		// Push each of the low bits to the high bit
-		ASCII = vshlq_n_u8(ASCII, 7);
-		// Shift each bit into a unique position
-		ASCII = vshlq_u8(ASCII, Shift);
-		// Horizontally reduce bytes, using "add" as "or" since each bit is
-		// uniquely positioned
-		Output[i + 0] = vaddv_u8(vget_low_u8(ASCII));
-		Output[i + 1] = vaddv_u8(vget_high_u8(ASCII));
+		// Pairwise additions reduce each 8-byte lane to a single byte
+		uint8x16_t Sum = vpaddq_u8(
+			DecodeBits(ASCII.val[0]), DecodeBits(ASCII.val[1])
+		);
+		Sum = vpaddq_u8(Sum, Sum);
+		Sum = vpaddq_u8(Sum, Sum);
+		vst1q_lane_u32(
+			reinterpret_cast<std::uint32_t*>(Output + i),
+			vreinterpretq_u32_u8(Sum), 0
+		);
+	}
+
+	Decode<1>(Input + i, Output + i, Length % 4);
+}
+
+// Eight at a time
+template<>
+inline void Decode<3>(
+	const std::uint64_t Input[], std::uint8_t Output[], std::size_t Length
+)
+{
+	std::size_t i = 0;
+	for( ; i + 7 < Length; i += 8 )
+	{
+		const uint8x16x4_t ASCII = vld1q_u8_x4(
+			reinterpret_cast<const std::uint8_t*>(Input + i)
+		);
+		// Pairwise additions reduce each 8-byte lane to a single byte
+		const uint8x16_t Sum = vpaddq_u8(
+			vpaddq_u8(DecodeBits(ASCII.val[0]), DecodeBits(ASCII.val[1])),
+			vpaddq_u8(DecodeBits(ASCII.val[2]), DecodeBits(ASCII.val[3]))
+		);
+		vst1_u8(Output + i, vget_low_u8(vpaddq_u8(Sum, Sum)));
 	}
 
-	Decode<0>(Input + i * 2, Output + i * 2, Length % 2);
+	Decode<2>(Input + i, Output + i, Length % 8);
+}
+
+}
+
+/// Validated decoding
+
+namespace
+{
+
+// Each level validates its ascii-bytes on the same registers that it decodes
+// them from, and upon finding an invalid byte hands the rest of the input down
+// to the level below it, down to the serial level which finds its offset.
+// Returns the offset of the first invalid byte, or `Length * 8`.
+
+// Recursive device
+template<std::uint8_t WidthExp2>
+inline std::size_t DecodeChecked(
+	const std::uint64_t Input[], std::uint8_t Output[], std::size_t Length
+)
+{
+	return DecodeChecked<WidthExp2-1>(Input, Output, Length);
 }
 
+// Serial
+template<>
+inline std::size_t DecodeChecked<0>(
+	const std::uint64_t Input[], std::uint8_t Output[], std::size_t Length
+)
+{
+	for( std::size_t i = 0; i < Length; ++i )
+	{
+		// Non-zero bytes are neither `0` nor `1`
+		const std::uint64_t Invalid
+			= (Input[i] & 0xFEFEFEFEFEFEFEFEUL) ^ 0x3030303030303030UL;
+		if( Invalid )
+		{
+			return i * 8 + __builtin_ctzll(Invalid) / 8;
+		}
+		Decode<0>(Input + i, Output + i, 1);
+	}
+	return Length * 8;
 }
 
-void Base2::Decode(
+// Two at a time
+template<>
+inline std::size_t DecodeChecked<1>(
 	const std::uint64_t Input[], std::uint8_t Output[], std::size_t Length
 )
 {
-	::Decode<0xFFu>(Input, Output, Length);
+	std::size_t i = 0;
+	for( ; i + 1 < Length; i += 2 )
+	{
+		const uint8x16_t ASCII = vld1q_u8(
+			reinterpret_cast<const std::uint8_t*>(Input + i)
+		);
+		const uint8x16_t Binary = vceqq_u8(
+			vandq_u8(ASCII, vdupq_n_u8(0xFE)), vdupq_n_u8('0')
+		);
+		if( vminvq_u8(Binary) != 0xFF ) break;
+		Decode2(ASCII, Output + i);
+	}
+
+	return i * 8 + DecodeChecked<0>(Input + i, Output + i, Length - i);
+}
+
 }
 
 /// Filtering
 
-std::size_t Base2::Filter(std::uint8_t Bytes[], std::size_t Length)
+namespace
+{
+
+// Indices that gather the valid bytes of an 8-byte lane to its front, for each
+// 8-bit mask of which bytes are valid
+struct CompactTable
 {
+	std::uint8_t Indices[256][8] = {};
+
+	constexpr CompactTable()
+	{
+		for( std::size_t Mask = 0; Mask < 256; ++Mask )
+		{
+			std::size_t Count = 0;
+			for( std::uint8_t k = 0; k < 8; ++k )
+			{
+				if( Mask & (1u << k) )
+				{
+					Indices[Mask][Count++] = k;
+				}
+			}
+		}
+	}
+};
+
+constexpr CompactTable Compact{};
+
+std::size_t Filter(std::uint8_t Bytes[], std::size_t Length)
+{
+	const uint8x16_t LaneBits = {
+		1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128
+	};
 	std::size_t End = 0;
 	std::size_t i = 0;
 	// Check and compress 16 bytes at a time
 	for( ; i + 15 < Length; i += 16 )
 	{
-		// Read in 8 bytes at once
 		const uint8x16_t Word128 = vld1q_u8(Bytes + i);
 
 		// Check for valid bytes, in parallel
-		if(
-			vaddvq_s64(
-				vreinterpretq_s64_u8(
-					vceqq_u8(
-						vandq_u8(Word128, vdupq_n_u8(0xFE)),
-						vdupq_n_u8('0')
-					)
-				)
-			) == -2
-		)
+		const uint8x16_t Valid = vceqq_u8(
+			vandq_u8(Word128, vdupq_n_u8(0xFE)), vdupq_n_u8('0')
+		);
+		if( vminvq_u8(Valid) == 0xFF )
 		{
-			// We have 8 valid ascii-binary bytes
+			// We have 16 valid ascii-binary bytes
 			vst1q_u8(Bytes + End, Word128);
 			End += 16;
+			continue;
 		}
-		else
-		{
-			// There is garbage
-			for( std::size_t k = 0; k < 16; ++k )
-			{
-				const std::uint8_t CurByte = Bytes[i + k];
-				if( (CurByte & 0xFE) != 0x30 ) continue;
-				Bytes[End++] = CurByte;
-			}
-		}
+
+		// There is garbage, gather the valid bytes of each 8-byte lane to the
+		// front of the lane with a table lookup. The whole block has already
+		// been loaded, so both stores only overwrite bytes that were consumed.
+		const uint8x16_t LaneMask = vandq_u8(Valid, LaneBits);
+		const std::uint8_t LowMask  = vaddv_u8(vget_low_u8(LaneMask));
+		const std::uint8_t HighMask = vaddv_u8(vget_high_u8(LaneMask));
+		const uint8x16_t Indices = vcombine_u8(
+			vld1_u8(Compact.Indices[LowMask]),
+			vadd_u8(vld1_u8(Compact.Indices[HighMask]), vdup_n_u8(8))
+		);
+		const uint8x16_t Compacted = vqtbl1q_u8(Word128, Indices);
+		vst1_u8(Bytes + End, vget_low_u8(Compacted));
+		End += __builtin_popcount(LowMask);
+		vst1_u8(Bytes + End, vget_high_u8(Compacted));
+		End += __builtin_popcount(HighMask);
 	}
 	// Check and compress 8 bytes at a time
 	for( ; i + 7 < Length; i += 8 )
@@ -258,3 +479,45 @@ std::size_t Base2::Filter(std::uint8_t Bytes[], std::size_t Length)
 	}
 	return End;
 }
+
+}
+
+/// Fused filtering and decoding
+
+namespace
+{
+
+std::size_t FilterDecode(
+	const std::uint8_t Input[], std::uint8_t Output[], std::size_t Length,
+	Base2::DecodeCarry& Carry
+)
+{
+	return FilterDecodeStaged(
+		::Filter, ::Decode<0xFFu>, Input, Output, Length, Carry
+	);
+}
+
+}
+
+/// Line-wrapped decoding
+
+namespace
+{
+
+std::size_t DecodeWrapped(
+	const std::uint8_t Input[], std::uint8_t Output[], std::size_t Length,
+	std::size_t WrapWidth, Base2::DecodeCarry& Carry
+)
+{
+	return DecodeWrappedStaged(
+		::DecodeChecked<0xFFu>, ::FilterDecode, Input, Output, Length, WrapWidth, Carry
+	);
+}
+
+}
+
+const Base2::Kernels::Table Base2::Kernels::BASE2_TIER = {
+	::Encode<0xFFu>, ::Decode<0xFFu>, ::Filter, ::EncodeWrapped,
+	::FilterDecode, ::DecodeChecked<0xFFu>, ::DecodeWrapped,
+	::Encode<0xFFu>, ::EncodeFormatted
+};
@@ -1,5 +1,11 @@
 #include <x86intrin.h>
 
+// GFNI's `gf2p8affineqb` multiplies each byte `x` by the 8x8 bit-matrix held
+// in its 64-bit lane `A`, where bit `i` of the result is the parity of
+// `x & A.byte[7 - i]`, and then xors in a constant byte. With the data as the
+// matrix and single bits as `x`, it gathers one bit out of each of the eight
+// bytes of the lane(and one bit of a single byte, when the others are zero).
+
 /// Encoding
 
 namespace
@@ -48,178 +54,538 @@ inline void Encode<0>(
 #endif
 }
 
-// Two at a time
 #if defined(__SSE2__)
+// Encodes two bytes into 16 ascii-bytes
+inline __m128i Encode2( const std::uint8_t Input[] )
+{
+	constexpr std::uint64_t UniqueBit     = 0x0102040810204080UL;
+
+#if defined(__GFNI__)
+	constexpr std::uint64_t MatrixRow = 0x0080808080808080UL;
+	__m128i Result = _mm_set1_epi16(
+		*reinterpret_cast<const std::uint16_t*>(Input)
+	);
+	// Each byte becomes the only row of the matrix of its 64-bit lane
+	Result = _mm_shuffle_epi8(
+		Result,
+		_mm_set_epi64x(MatrixRow | (1UL << 56), MatrixRow | (0UL << 56))
+	);
+	// Each ascii-byte picks its bit out of the row and adds it to '0'
+	Result = _mm_gf2p8affine_epi64_epi8(
+		_mm_set1_epi64x(UniqueBit), Result, '0'
+	);
+#else
+	constexpr std::uint64_t LSB8          = 0x0101010101010101UL;
+	constexpr std::uint64_t CarryShift    = 0x7F7E7C7870604000UL;
+#if defined(__SSSE3__)
+	__m128i Result = _mm_set1_epi16(
+		*reinterpret_cast<const std::uint16_t*>(Input)
+	);
+	// Upper and lower 64-bits get filled with bytes
+	Result = _mm_shuffle_epi8(Result, _mm_set_epi64x(LSB8 * 1, LSB8 * 0));
+#else
+	__m128i Result = _mm_set_epi64x(
+		LSB8 * static_cast<std::uint64_t>(Input[1]),
+		LSB8 * static_cast<std::uint64_t>(Input[0])
+	);
+#endif
+	// Mask Unique bits per byte
+	Result = _mm_and_si128(Result, _mm_set1_epi64x(UniqueBit));
+	// Use the carry-bit to slide it to the far left
+	Result = _mm_add_epi64(Result, _mm_set1_epi64x(CarryShift));
+#if defined(__SSE4_1__)
+	// Pick between ascii '0' and '1', using the upper bit in each byte
+	Result = _mm_blendv_epi8(
+		_mm_set1_epi8('0'), _mm_set1_epi8('1'), Result
+	);
+#else
+	constexpr std::uint64_t BinAsciiBasis = LSB8 * '0';
+	constexpr std::uint64_t MSB8          = LSB8 << 7u;
+	// Mask this last bit
+	Result = _mm_and_si128(Result, _mm_set1_epi64x(MSB8));
+	// Shift it to the low bit of each byte
+	Result = _mm_srli_epi64(Result, 7);
+	// Convert it to ascii `0` and `1`
+	Result = _mm_or_si128(Result, _mm_set1_epi64x(BinAsciiBasis));
+#endif
+#endif
+	return Result;
+}
+
+// Two at a time
 template<>
 inline void Encode<1>(
 	const std::uint8_t Input[], std::uint64_t Output[], std::size_t Length
 )
 {
-	constexpr std::uint64_t LSB8          = 0x0101010101010101UL;
-	constexpr std::uint64_t UniqueBit     = 0x0102040810204080UL;
-	constexpr std::uint64_t CarryShift    = 0x7F7E7C7870604000UL;
-
 	std::size_t i = 0;
-	for( ; i < Length; i += 2 )
+	for( ; i + 1 < Length; i += 2 )
 	{
-	#if defined(__SSSE3__)
-		__m128i Result = _mm_set1_epi16(
-			*reinterpret_cast<const std::uint16_t*>(&Input[i])
-		);
-		// Upper and lower 64-bits get filled with bytes
-		Result = _mm_shuffle_epi8(Result, _mm_set_epi64x(LSB8 * 1, LSB8 * 0));
-	#else
-		__m128i Result = _mm_set_epi64x(
-			LSB8 * static_cast<std::uint64_t>(Input[i + 1]),
-			LSB8 * static_cast<std::uint64_t>(Input[i + 0])
+		_mm_storeu_si128(
+			reinterpret_cast<__m128i*>(&Output[i]), Encode2(&Input[i])
 		);
-	#endif
-		// Mask Unique bits per byte
-		Result = _mm_and_si128(Result, _mm_set1_epi64x(UniqueBit));
-		// Use the carry-bit to slide it to the far left
-		Result = _mm_add_epi64(Result, _mm_set1_epi64x(CarryShift));
-	#if defined(__SSE4_1__)
-		// Pick between ascii '0' and '1', using the upper bit in each byte
-		Result = _mm_blendv_epi8(
-			_mm_set1_epi8('0'), _mm_set1_epi8('1'), Result
-		);
-	#else
-		constexpr std::uint64_t BinAsciiBasis = LSB8 * '0';
-		constexpr std::uint64_t MSB8          = LSB8 << 7u;
-		// Mask this last bit
-		Result = _mm_and_si128(Result, _mm_set1_epi64x(MSB8));
-		// Shift it to the low bit of each byte
-		Result = _mm_srli_epi64(Result, 7);
-		// Convert it to ascii `0` and `1`
-		Result = _mm_or_si128(Result, _mm_set1_epi64x(BinAsciiBasis));
-	#endif
-		_mm_store_si128(reinterpret_cast<__m128i*>(&Output[i]), Result);
 	}
 
-	Encode<0>(Input + i * 2, Output + i * 2, Length % 2);
+	Encode<0>(Input + i, Output + i, Length % 2);
 }
 #endif
 
 #if defined(__AVX2__)
+// Encodes four bytes into 32 ascii-bytes
+inline __m256i Encode4( const std::uint8_t Input[] )
+{
+	constexpr std::uint64_t UniqueBit  = 0x0102040810204080UL;
+
+	__m256i Result = _mm256_set1_epi32(
+		*reinterpret_cast<const std::uint32_t*>(Input)
+	);
+#if defined(__GFNI__)
+	constexpr std::uint64_t MatrixRow = 0x0080808080808080UL;
+	// Each byte becomes the only row of the matrix of its 64-bit lane
+	Result = _mm256_shuffle_epi8(
+		Result,
+		_mm256_set_epi64x(
+			MatrixRow | (3UL << 56), MatrixRow | (2UL << 56),
+			MatrixRow | (1UL << 56), MatrixRow | (0UL << 56)
+		)
+	);
+	// Each ascii-byte picks its bit out of the row and adds it to '0'
+	return _mm256_gf2p8affine_epi64_epi8(
+		_mm256_set1_epi64x(UniqueBit), Result, '0'
+	);
+#else
+	constexpr std::uint64_t LSB8       = 0x0101010101010101UL;
+	constexpr std::uint64_t CarryShift = 0x7F7E7C7870604000UL;
+	// Broadcast each byte to each 64-bit lane
+	Result = _mm256_shuffle_epi8(
+		Result, _mm256_set_epi64x(LSB8 * 3, LSB8 * 2, LSB8 * 1, LSB8 * 0)
+	);
+	// Mask Unique bits per byte
+	Result = _mm256_and_si256(Result, _mm256_set1_epi64x(UniqueBit));
+	// Use the carry-bit of addition to slide it to the sign bit
+	Result = _mm256_add_epi64(Result, _mm256_set1_epi64x(CarryShift));
+	// Pick between ascii '0' and '1', using the upper bit in each byte
+	return _mm256_blendv_epi8(
+		_mm256_set1_epi8('0'), _mm256_set1_epi8('1'), Result
+	);
+#endif
+}
+
 // Four at a time
 template<>
 inline void Encode<2>(
 	const std::uint8_t Input[], std::uint64_t Output[], std::size_t Length
 )
 {
-	constexpr std::uint64_t LSB8       = 0x0101010101010101UL;
-	constexpr std::uint64_t UniqueBit  = 0x0102040810204080UL;
-	constexpr std::uint64_t CarryShift = 0x7F7E7C7870604000UL;
-
 	std::size_t i = 0;
-	for( ; i < Length; i += 4 )
+	for( ; i + 3 < Length; i += 4 )
 	{
-		__m256i Result = _mm256_set1_epi32(
-			*reinterpret_cast<const std::uint32_t*>(&Input[i])
+		_mm256_storeu_si256(
+			reinterpret_cast<__m256i*>(&Output[i]), Encode4(&Input[i])
 		);
-		// Broadcast each byte to each 64-bit lane
-		Result = _mm256_shuffle_epi8(
-			Result, _mm256_set_epi64x(LSB8 * 3, LSB8 * 2, LSB8 * 1, LSB8 * 0)
-		);
-		// Mask Unique bits per byte
-		Result = _mm256_and_si256(Result, _mm256_set1_epi64x(UniqueBit));
-		// Use the carry-bit of addition to slide it to the sign bit
-		Result = _mm256_add_epi64(Result, _mm256_set1_epi64x(CarryShift));
-		// Pick between ascii '0' and '1', using the upper bit in each byte
-		Result = _mm256_blendv_epi8(
-			_mm256_set1_epi8('0'), _mm256_set1_epi8('1'), Result
-		);
-		_mm256_storeu_si256( reinterpret_cast<__m256i*>(&Output[i]), Result);
 	}
 
-	Encode<1>(Input + i * 4, Output + i * 4, Length % 4);
+	Encode<1>(Input + i, Output + i, Length % 4);
 }
 #endif
 
 #if defined(__AVX512F__) && defined(__AVX512BITALG__)
-template<>
-inline void Encode<3>(
-	const std::uint8_t Input[], std::uint64_t Output[], std::size_t Length
-)
+// Encodes eight bytes into 64 ascii-bytes
+inline __m512i Encode8( const std::uint8_t Input[] )
 {
 	constexpr std::uint64_t LSB8          = 0x0101010101010101UL;
 
-	std::size_t i = 0;
-	for( ; i < Length; i += 8 )
-	{
-		// Reverse bits in each byte and convert it into an AVX512 mask,
-		// all in one instruction.
-		const __mmask64 Mask = _mm512_bitshuffle_epi64_mask(
-			_mm512_set1_epi64(*(const std::uint64_t*)&Input[i]),
-			_mm512_set_epi64(
-				0x00'01'02'03'04'05'06'07 + LSB8 * 0x38, // Byte 7
-				0x00'01'02'03'04'05'06'07 + LSB8 * 0x30, // Byte 6
-				0x00'01'02'03'04'05'06'07 + LSB8 * 0x28, // Byte 5
-				0x00'01'02'03'04'05'06'07 + LSB8 * 0x20, // Byte 4
-				0x00'01'02'03'04'05'06'07 + LSB8 * 0x18, // Byte 3
-				0x00'01'02'03'04'05'06'07 + LSB8 * 0x10, // Byte 2
-				0x00'01'02'03'04'05'06'07 + LSB8 * 0x08, // Byte 1
-				0x00'01'02'03'04'05'06'07 + LSB8 * 0x00  // Byte 0
-			)
-		);
-		// Use 64-bit mask to create 64 ascii-bytes(8 encoded bytes)
-		// by picking between '0' and '1' bytes
-		const __m512i Ascii = _mm512_mask_blend_epi8(
-			Mask, _mm512_set1_epi8('0'), _mm512_set1_epi8('1')
-		);
-		_mm512_storeu_si512(&Output[i], Ascii);
-	}
+	// Reverse bits in each byte and convert it into an AVX512 mask,
+	// all in one instruction.
+	const __mmask64 Mask = _mm512_bitshuffle_epi64_mask(
+		_mm512_set1_epi64(*(const std::uint64_t*)Input),
+		_mm512_set_epi64(
+			0x00'01'02'03'04'05'06'07 + LSB8 * 0x38, // Byte 7
+			0x00'01'02'03'04'05'06'07 + LSB8 * 0x30, // Byte 6
+			0x00'01'02'03'04'05'06'07 + LSB8 * 0x28, // Byte 5
+			0x00'01'02'03'04'05'06'07 + LSB8 * 0x20, // Byte 4
+			0x00'01'02'03'04'05'06'07 + LSB8 * 0x18, // Byte 3
+			0x00'01'02'03'04'05'06'07 + LSB8 * 0x10, // Byte 2
+			0x00'01'02'03'04'05'06'07 + LSB8 * 0x08, // Byte 1
+			0x00'01'02'03'04'05'06'07 + LSB8 * 0x00  // Byte 0
+		)
+	);
+	// Use 64-bit mask to create 64 ascii-bytes(8 encoded bytes)
+	// by picking between '0' and '1' bytes
+	return _mm512_mask_blend_epi8(
+		Mask, _mm512_set1_epi8('0'), _mm512_set1_epi8('1')
+	);
+}
+#elif defined(__AVX512F__) && defined(__AVX512BW__) && defined(__GFNI__)
+// Encodes eight bytes into 64 ascii-bytes
+inline __m512i Encode8( const std::uint8_t Input[] )
+{
+	constexpr std::uint64_t UniqueBit     = 0x0102040810204080UL;
+	constexpr std::uint64_t MatrixRow     = 0x0080808080808080UL;
 
-	Encode<2>(Input + i * 8, Output + i * 8, Length % 8);
+	// Load 8 bytes, and broadcast it across all 8 64-bit lanes
+	__m512i Bytes8 = _mm512_set1_epi64(
+		*reinterpret_cast<const std::uint64_t*>(Input)
+	);
+	// Each byte becomes the only row of the matrix of its 64-bit lane
+	Bytes8 = _mm512_shuffle_epi8(
+		Bytes8, _mm512_set_epi64(
+			MatrixRow | (7UL << 56), MatrixRow | (6UL << 56),
+			MatrixRow | (5UL << 56), MatrixRow | (4UL << 56),
+			MatrixRow | (3UL << 56), MatrixRow | (2UL << 56),
+			MatrixRow | (1UL << 56), MatrixRow | (0UL << 56)
+		)
+	);
+	// Each ascii-byte picks its bit out of the row and adds it to '0'
+	return _mm512_gf2p8affine_epi64_epi8(
+		_mm512_set1_epi64(UniqueBit), Bytes8, '0'
+	);
 }
 #elif defined(__AVX512F__) && defined(__AVX512BW__)
+// Encodes eight bytes into 64 ascii-bytes
+inline __m512i Encode8( const std::uint8_t Input[] )
+{
+	constexpr std::uint64_t LSB8          = 0x0101010101010101UL;
+	constexpr std::uint64_t UniqueBit     = 0x0102040810204080UL;
+
+	// Load 8 bytes, and broadcast it across all 8 64-bit lanes
+	__m512i Bytes8 = _mm512_set1_epi64(
+		*reinterpret_cast<const std::uint64_t*>(Input)
+	);
+	// "Unzip" each byte across each 64-bit lane
+	Bytes8 = _mm512_shuffle_epi8(
+		Bytes8, _mm512_set_epi64(
+			LSB8 * 7, LSB8 * 6, LSB8 * 5, LSB8 * 4,
+			LSB8 * 3, LSB8 * 2, LSB8 * 1, LSB8 * 0
+		)
+	);
+	// Get unique bits in each byte into a 64-bit mask
+	const __mmask64 BitMask = _mm512_test_epi8_mask(
+		Bytes8, _mm512_set1_epi64(UniqueBit)
+	);
+	// Use the mask to select between ASCII bytes `0` and `1`
+	return _mm512_mask_blend_epi8(
+		BitMask, _mm512_set1_epi8('0'), _mm512_set1_epi8('1')
+	);
+}
+#endif
+
+#if defined(__AVX512F__) && defined(__AVX512BW__)
 // Eight at a time
 template<>
 inline void Encode<3>(
 	const std::uint8_t Input[], std::uint64_t Output[], std::size_t Length
 )
 {
-	constexpr std::uint64_t LSB8          = 0x0101010101010101UL;
-	constexpr std::uint64_t UniqueBit     = 0x0102040810204080UL;
-
 	std::size_t i = 0;
-	for( ; i < Length; i += 8 )
+	for( ; i + 7 < Length; i += 8 )
 	{
-		// Load 8 bytes, and broadcast it across all 8 64-bit lanes
-		__m512i Bytes8 = _mm512_set1_epi64(
-			*reinterpret_cast<const std::uint64_t*>(&Input[i])
+		_mm512_storeu_si512(
+			reinterpret_cast<__m512i*>(&Output[i]), Encode8(&Input[i])
 		);
-		// "Unzip" each byte across each 64-bit lane
-		Bytes8 = _mm512_shuffle_epi8(
-			Bytes8, _mm512_set_epi64(
-				LSB8 * 7, LSB8 * 6, LSB8 * 5, LSB8 * 4,
-				LSB8 * 3, LSB8 * 2, LSB8 * 1, LSB8 * 0
-			)
+	}
+
+	// The last 1-7 bytes are encoded in full and stored under a mask, which
+	// never touches memory past the end of the output
+	if( const std::size_t Tail = Length - i )
+	{
+		std::uint64_t Bytes = 0;
+		std::memcpy(&Bytes, &Input[i], Tail);
+		_mm512_mask_storeu_epi8(
+			&Output[i], _bzhi_u64(~0UL, Tail * 8),
+			Encode8(reinterpret_cast<const std::uint8_t*>(&Bytes))
 		);
-		// Get unique bits in each byte into a 64-bit mask
-		const __mmask64 BitMask = _mm512_test_epi8_mask(
-			Bytes8, _mm512_set1_epi64(UniqueBit)
+	}
+}
+#endif
+}
+
+/// Non-temporal encoding
+
+namespace
+{
+
+#if defined(__AVX512F__) && defined(__AVX512BW__)
+constexpr std::size_t StreamWidth = 64;
+#elif defined(__AVX2__)
+constexpr std::size_t StreamWidth = 32;
+#else
+constexpr std::size_t StreamWidth = 16;
+#endif
+
+// Writes the output past the cache with non-temporal stores of whole aligned
+// vectors. The bytes before the first aligned vector and after the last one
+// use regular stores, and the non-temporal stores are fenced so that they are
+// ordered before any store that follows.
+void EncodeNonTemporal(
+	const std::uint8_t Input[], std::uint64_t Output[], std::size_t Length
+)
+{
+	const std::uintptr_t Address = reinterpret_cast<std::uintptr_t>(Output);
+	if( Address % 8 )
+	{
+		// No byte of input ever lines up with a vector boundary
+		Encode<0xFFu>(Input, Output, Length);
+		return;
+	}
+	std::size_t i = std::min<std::size_t>(
+		(StreamWidth - Address % StreamWidth) % StreamWidth / 8, Length
+	);
+	Encode<0xFFu>(Input, Output, i);
+#if defined(__AVX512F__) && defined(__AVX512BW__)
+	for( ; i + 7 < Length; i += 8 )
+	{
+		_mm512_stream_si512(
+			reinterpret_cast<__m512i*>(&Output[i]), Encode8(&Input[i])
 		);
-		// Use the mask to select between ASCII bytes `0` and `1`
-		const __m512i ASCII = _mm512_mask_blend_epi8(
-			BitMask, _mm512_set1_epi8('0'), _mm512_set1_epi8('1')
+	}
+#elif defined(__AVX2__)
+	for( ; i + 3 < Length; i += 4 )
+	{
+		_mm256_stream_si256(
+			reinterpret_cast<__m256i*>(&Output[i]), Encode4(&Input[i])
 		);
-		_mm512_storeu_si512(reinterpret_cast<__m512i*>(&Output[i]), ASCII);
 	}
+#else
+	for( ; i + 1 < Length; i += 2 )
+	{
+		_mm_stream_si128(
+			reinterpret_cast<__m128i*>(&Output[i]), Encode2(&Input[i])
+		);
+	}
+#endif
+	_mm_sfence();
+	Encode<0xFFu>(Input + i, Output + i, Length - i);
+}
+
+}
+
+/// Line-wrapped encoding
 
-	Encode<2>(Input + i * 8, Output + i * 8, Length % 8);
+namespace
+{
+
+#if defined(__AVX512F__) && defined(__AVX512BW__)
+// Eight bytes at a time, with the newline that falls within each 64 digits
+// placed by storing the digits on either side of it with two masked stores
+std::size_t EncodeWrapped(
+	const std::uint8_t Input[], char Output[], std::size_t Length,
+	std::size_t WrapWidth, std::size_t Column
+)
+{
+	// Lines narrower than a vector may need more than one newline per vector
+	if( WrapWidth < 64 )
+	{
+		return EncodeWrappedStaged(
+			::Encode<0xFFu>, Input, Output, Length, WrapWidth, Column
+		);
+	}
+	std::size_t i = 0;
+	for( ; i + 7 < Length; i += 8 )
+	{
+		const __m512i Ascii = Encode8(&Input[i]);
+		if( Column == WrapWidth )
+		{
+			*Output++ = '\n';
+			Column = 0;
+		}
+		const std::size_t Room = WrapWidth - Column;
+		if( Room >= 64 )
+		{
+			_mm512_storeu_si512(Output, Ascii);
+			Output += 64;
+			Column += 64;
+		}
+		else
+		{
+			const __mmask64 Head = _cvtu64_mask64(_bzhi_u64(~0ULL, Room));
+			_mm512_mask_storeu_epi8(Output, Head, Ascii);
+			Output[Room] = '\n';
+			_mm512_mask_storeu_epi8(Output + 1, _knot_mask64(Head), Ascii);
+			Output += 65;
+			Column = 64 - Room;
+		}
+	}
+	return EncodeWrappedStaged(
+		::Encode<0xFFu>, Input + i, Output, Length % 8, WrapWidth, Column
+	);
+}
+#elif defined(__AVX2__)
+// Four bytes at a time, with the newline that falls within each 32 digits
+// placed by blending the digits with a copy of them shifted up by one byte
+std::size_t EncodeWrapped(
+	const std::uint8_t Input[], char Output[], std::size_t Length,
+	std::size_t WrapWidth, std::size_t Column
+)
+{
+	// Lines narrower than a vector may need more than one newline per vector
+	if( WrapWidth < 32 )
+	{
+		return EncodeWrappedStaged(
+			::Encode<0xFFu>, Input, Output, Length, WrapWidth, Column
+		);
+	}
+	const __m256i LaneIndex = _mm256_setr_epi8(
+		 0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14, 15,
+		16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31
+	);
+	std::size_t i = 0;
+	for( ; i + 3 < Length; i += 4 )
+	{
+		const __m256i Ascii = Encode4(&Input[i]);
+		if( Column == WrapWidth )
+		{
+			*Output++ = '\n';
+			Column = 0;
+		}
+		const std::size_t Room = WrapWidth - Column;
+		if( Room >= 32 )
+		{
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(Output), Ascii);
+			Output += 32;
+			Column += 32;
+		}
+		else
+		{
+			// Shift all digits up by one byte, across both 128-bit lanes
+			const __m256i Shifted = _mm256_alignr_epi8(
+				Ascii, _mm256_permute2x128_si256(Ascii, Ascii, 0x08), 15
+			);
+			const __m256i Split = _mm256_set1_epi8(static_cast<char>(Room));
+			// Digits before the newline stay in place, the ones after it move
+			// up by one
+			__m256i Line = _mm256_blendv_epi8(
+				Shifted, Ascii, _mm256_cmpgt_epi8(Split, LaneIndex)
+			);
+			Line = _mm256_blendv_epi8(
+				Line, _mm256_set1_epi8('\n'), _mm256_cmpeq_epi8(Split, LaneIndex)
+			);
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(Output), Line);
+			// The last digit was shifted out of the vector
+			Output[32] = static_cast<char>(_mm256_extract_epi8(Ascii, 31));
+			Output += 33;
+			Column = 32 - Room;
+		}
+	}
+	return EncodeWrappedStaged(
+		::Encode<0xFFu>, Input + i, Output, Length % 4, WrapWidth, Column
+	);
+}
+#else
+std::size_t EncodeWrapped(
+	const std::uint8_t Input[], char Output[], std::size_t Length,
+	std::size_t WrapWidth, std::size_t Column
+)
+{
+	return EncodeWrappedStaged(
+		::Encode<0xFFu>, Input, Output, Length, WrapWidth, Column
+	);
 }
 #endif
+
 }
 
+/// Formatted encoding
 
-void Base2::Encode(
-	const std::uint8_t Input[], std::uint64_t Output[], std::size_t Length
+namespace
+{
+
+#if defined(__SSSE3__)
+// Stores records of up to a vector by shuffling the digits of a byte into
+// their slot and or-ing them into the text, which has zeros in that slot
+struct StoreRecordShuffle : StoreRecordCopy
+{
+	// Each lane takes the digit at its distance past the slot, lanes before
+	// it are negative and lanes after it index the zeroed upper half
+	__m128i DigitSlot;
+
+	explicit StoreRecordShuffle( const FormatRecord& Record )
+		: StoreRecordCopy(Record),
+		  DigitSlot(_mm_sub_epi8(
+			_mm_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15),
+			_mm_set1_epi8(static_cast<char>(Record.DigitOffset))
+		  ))
+	{
+	}
+
+	template<std::size_t CopySize>
+	void StoreRecord( char* Output, std::uint64_t Digits ) const
+	{
+		if( CopySize != 16 || Record.DigitOffset > 8 )
+		{
+			return StoreRecordCopy::StoreRecord<CopySize>(Output, Digits);
+		}
+		const __m128i Text = _mm_load_si128(
+			reinterpret_cast<const __m128i*>(Record.Text)
+		);
+		const __m128i Slot = _mm_shuffle_epi8(
+			_mm_cvtsi64_si128(static_cast<long long>(Digits)), DigitSlot
+		);
+		_mm_storeu_si128(
+			reinterpret_cast<__m128i*>(Output), _mm_or_si128(Text, Slot)
+		);
+	}
+};
+#endif
+
+#if defined(__AVX512F__) && defined(__AVX512BW__) && defined(__AVX512VBMI2__)
+// Stores whole vectors of records at a time by expanding the digits into the
+// lanes of their slots within the template of the text for the phase of the
+// record that the vector starts at
+struct StoreRecordExpand : StoreRecordShuffle
+{
+	using StoreRecordShuffle::StoreRecordShuffle;
+
+	std::size_t StoreBlock(
+		char* Output, const char*, const std::uint64_t Digits[],
+		std::size_t Count
+	) const
+	{
+		if( Record.GroupSize != 1 )
+		{
+			return 0;
+		}
+		// `Digits` has room to be read a vector past its last byte
+		const std::uint8_t* DigitBytes
+			= reinterpret_cast<const std::uint8_t*>(Digits);
+		const std::size_t Size = Count * Record.Size;
+		std::size_t Phase = 0;
+		std::size_t i = 0;
+		for( ; i + 64 <= Size; i += 64 )
+		{
+			const __m512i Text = _mm512_load_si512(Record.Templates[Phase]);
+			_mm512_storeu_si512(
+				Output + i, _mm512_mask_expand_epi8(
+					Text, _cvtu64_mask64(Record.Slots[Phase]),
+					_mm512_loadu_si512(DigitBytes)
+				)
+			);
+			DigitBytes += Record.Taken[Phase];
+			Phase = (Phase + 64) % Record.Size;
+		}
+		// The record that the last vector ended within is stored again
+		return i / Record.Size;
+	}
+};
+
+using StoreRecordVector = StoreRecordExpand;
+#elif defined(__SSSE3__)
+using StoreRecordVector = StoreRecordShuffle;
+#else
+using StoreRecordVector = StoreRecordCopy;
+#endif
+
+std::size_t EncodeFormatted(
+	const std::uint8_t Input[], char Output[], std::size_t Length,
+	const FormatRecord& Record, std::uint64_t Position
 )
 {
-	::Encode<0xFFu>(Input, Output, Length);
+	return EncodeFormattedStaged<StoreRecordVector>(
+		::Encode<0xFFu>, Input, Output, Length, Record, Position
+	);
 }
 
+}
 
 /// Decoding
 
@@ -270,12 +636,12 @@ inline void Decode<1>(
 	const std::uint64_t Input[], std::uint8_t Output[], std::size_t Length
 )
 {
-	constexpr std::uint64_t LSB8 = 0x0101010101010101UL;
 	std::size_t i = 0;
-	for( ; i < Length; i += 2 )
+	for( ; i + 1 < Length; i += 2 )
 	{
 		// Load in 16 bytes of endian-swapped ascii bytes
 	#if defined(__SSSE3__)
+		constexpr std::uint64_t LSB8 = 0x0101010101010101UL;
 		__m128i ASCII = _mm_loadu_si128(
 			reinterpret_cast<const __m128i*>(&Input[i])
 		);
@@ -297,112 +663,264 @@ inline void Decode<1>(
 		*reinterpret_cast<std::uint16_t*>(&Output[i]) = _mm_movemask_epi8(ASCII);
 	}
 
-	Decode<0>(Input + i * 2, Output + i * 2, Length % 2);
+	Decode<0>(Input + i, Output + i, Length % 2);
 }
 #endif
 
 // Four at a time
 #if defined(__AVX2__)
+// Decodes 32 ascii-bytes into four bytes
+inline std::uint32_t Decode4( __m256i ASCII )
+{
+	constexpr std::uint64_t LSB8 = 0x0101010101010101UL;
+	// Reverse each 8-byte element in each 128-bit lane
+	ASCII = _mm256_shuffle_epi8(
+		ASCII,
+		_mm256_set_epi64x(
+			0x0001020304050607 + LSB8 * 0x08,
+			0x0001020304050607 + LSB8 * 0x00,
+			0x0001020304050607 + LSB8 * 0x08,
+			0x0001020304050607 + LSB8 * 0x00
+		)
+	);
+	// Shift lowest bit of each byte into sign bit
+	ASCII = _mm256_slli_epi64(ASCII, 7);
+	return _mm256_movemask_epi8(ASCII);
+}
+
 template<>
 inline void Decode<2>(
 	const std::uint64_t Input[], std::uint8_t Output[], std::size_t Length
 )
 {
-	constexpr std::uint64_t LSB8 = 0x0101010101010101UL;
 	std::size_t i = 0;
-	for( ; i < Length; i += 4 )
+	for( ; i + 3 < Length; i += 4 )
 	{
-		// Load in 32 bytes of endian-swapped ascii bytes
-		__m256i ASCII = _mm256_loadu_si256(
+		// Load in 32 bytes of ascii bytes
+		const __m256i ASCII = _mm256_loadu_si256(
 			reinterpret_cast<const __m256i*>(&Input[i])
 		);
-		// Reverse each 8-byte element in each 128-bit lane
-		ASCII = _mm256_shuffle_epi8(
-			ASCII,
-			_mm256_set_epi64x(
-				0x0001020304050607 + LSB8 * 0x08,
-				0x0001020304050607 + LSB8 * 0x00,
-				0x0001020304050607 + LSB8 * 0x08,
-				0x0001020304050607 + LSB8 * 0x00
-			)
-		);
-		// Shift lowest bit of each byte into sign bit
-		ASCII = _mm256_slli_epi64(ASCII, 7);
-		*reinterpret_cast<std::uint32_t*>(&Output[i]) = _mm256_movemask_epi8(ASCII);
+		*reinterpret_cast<std::uint32_t*>(&Output[i]) = Decode4(ASCII);
 	}
 
-	Decode<1>(Input + i * 4, Output + i * 4, Length % 4);
+	Decode<1>(Input + i, Output + i, Length % 4);
 }
 #endif
 
 // Eight at a time
 #if defined(__AVX512F__) && defined(__AVX512BITALG__)
+// Decodes 64 ascii-bytes into eight bytes
+inline std::uint64_t Decode8( __m512i ASCII )
+{
+	return _cvtmask64_u64(
+		_mm512_bitshuffle_epi64_mask(
+			ASCII,
+			// Samples ascii bits in an endian-swapped order
+			_mm512_set1_epi64(0x00'08'10'18'20'28'30'38)
+		)
+	);
+}
+#elif defined(__AVX512F__) && defined(__AVX512BW__) && defined(__GFNI__)
+// Decodes 64 ascii-bytes into eight bytes
+// Narrower widths keep `movemask`, as picking one byte out of each lane
+// costs more there than the byte-reversal it saves
+inline std::uint64_t Decode8( __m512i ASCII )
+{
+	// Gather the low bit of each ascii-byte of each 64-bit lane, into every
+	// byte of the lane
+	ASCII = _mm512_gf2p8affine_epi64_epi8(_mm512_set1_epi8(0x01), ASCII, 0);
+	// Pick one byte of each lane
+	return _mm_cvtsi128_si64(_mm512_maskz_cvtepi64_epi8(0xFF, ASCII));
+}
+#elif defined(__AVX512F__) && defined(__AVX512BW__)
+// Decodes 64 ascii-bytes into eight bytes
+inline std::uint64_t Decode8( __m512i ASCII )
+{
+	constexpr std::uint64_t LSB8 = 0x0101010101010101UL;
+	// Endian-swap each group of 8 ascii bytes
+	ASCII = _mm512_shuffle_epi8(
+		ASCII,
+		_mm512_set_epi64(
+			0x0001020304050607 + LSB8 * 0x38,
+			0x0001020304050607 + LSB8 * 0x30,
+			0x0001020304050607 + LSB8 * 0x28,
+			0x0001020304050607 + LSB8 * 0x20,
+			0x0001020304050607 + LSB8 * 0x18,
+			0x0001020304050607 + LSB8 * 0x10,
+			0x0001020304050607 + LSB8 * 0x08,
+			0x0001020304050607 + LSB8 * 0x00
+		)
+	);
+	return _cvtmask64_u64(
+		_mm512_test_epi8_mask(ASCII, _mm512_set1_epi8(0x01))
+	);
+}
+#endif
+
+#if defined(__AVX512F__) && defined(__AVX512BW__)
 template<>
 inline void Decode<3>(
 	const std::uint64_t Input[], std::uint8_t Output[], std::size_t Length
 )
 {
 	std::size_t i = 0;
-	for( ; i < Length; i += 8 )
+	for( ; i + 7 < Length; i += 8 )
 	{
-		const __mmask64 Compressed = _mm512_bitshuffle_epi64_mask(
-			_mm512_loadu_si512(reinterpret_cast<const __m512i*>(Input + i)),
-			// Samples ascii bits in an endian-swapped order
-			_mm512_set1_epi64(0x00'08'10'18'20'28'30'38)
+		// Load in 64 bytes of ascii bytes
+		const __m512i ASCII = _mm512_loadu_si512(
+			reinterpret_cast<const __m512i*>(&Input[i])
 		);
-		_store_mask64(reinterpret_cast<__mmask64*>(Output + i), Compressed);
+		*reinterpret_cast<std::uint64_t*>(&Output[i]) = Decode8(ASCII);
 	}
 
-	Decode<2>(Input + i * 8, Output + i * 8, Length % 8);
+	// The last 1-7 groups of ascii bytes are loaded and stored under a mask,
+	// which never touches memory past the end of either buffer
+	if( const std::size_t Tail = Length - i )
+	{
+		const __m512i ASCII = _mm512_maskz_loadu_epi8(
+			_bzhi_u64(~0UL, Tail * 8), &Input[i]
+		);
+		_mm512_mask_storeu_epi8(
+			&Output[i], _bzhi_u64(~0UL, Tail),
+			_mm512_set1_epi64(Decode8(ASCII))
+		);
+	}
 }
-#elif defined(__AVX512F__) && defined(__AVX512BW__)
+#endif
+}
+
+/// Validated decoding
+
+namespace
+{
+
+// Each level validates its ascii-bytes on the same registers that it decodes
+// them from, and upon finding an invalid byte hands the rest of the input down
+// to the level below it, down to the serial level which finds its offset.
+// Returns the offset of the first invalid byte, or `Length * 8`.
+
+// Recursive device
+template<std::uint8_t WidthExp2>
+inline std::size_t DecodeChecked(
+	const std::uint64_t Input[], std::uint8_t Output[], std::size_t Length
+)
+{
+	return DecodeChecked<WidthExp2-1>(Input, Output, Length);
+}
+
+// Serial
 template<>
-inline void Decode<3>(
+inline std::size_t DecodeChecked<0>(
+	const std::uint64_t Input[], std::uint8_t Output[], std::size_t Length
+)
+{
+	for( std::size_t i = 0; i < Length; ++i )
+	{
+		// Non-zero bytes are neither `0` nor `1`
+		const std::uint64_t Invalid
+			= (Input[i] & 0xFEFEFEFEFEFEFEFEUL) ^ 0x3030303030303030UL;
+		if( Invalid )
+		{
+			return i * 8 + __builtin_ctzll(Invalid) / 8;
+		}
+		Decode<0>(Input + i, Output + i, 1);
+	}
+	return Length * 8;
+}
+
+// Two at a time
+#if defined(__SSE2__)
+template<>
+inline std::size_t DecodeChecked<1>(
 	const std::uint64_t Input[], std::uint8_t Output[], std::size_t Length
 )
 {
-	constexpr std::uint64_t LSB8 = 0x0101010101010101UL;
 	std::size_t i = 0;
-	for( ; i < Length; i += 8 )
+	for( ; i + 1 < Length; i += 2 )
 	{
-		// Load in 64 bytes of endian-swapped ascii bytes
-		__m512i ASCII = _mm512_loadu_si512(
-			reinterpret_cast<const __m512i*>(&Input[i])
+		const __m128i ASCII = _mm_loadu_si128(
+			reinterpret_cast<const __m128i*>(&Input[i])
 		);
-		ASCII = _mm512_shuffle_epi8(
-			ASCII,
-			_mm512_set_epi64(
-				0x0001020304050607 + LSB8 * 0x38,
-				0x0001020304050607 + LSB8 * 0x30,
-				0x0001020304050607 + LSB8 * 0x28,
-				0x0001020304050607 + LSB8 * 0x20,
-				0x0001020304050607 + LSB8 * 0x18,
-				0x0001020304050607 + LSB8 * 0x10,
-				0x0001020304050607 + LSB8 * 0x08,
-				0x0001020304050607 + LSB8 * 0x00
+	#if defined(__SSE4_1__)
+		// Any bits other than the lowest differing from `0` are invalid
+		if(
+			!_mm_testz_si128(
+				_mm_xor_si128(ASCII, _mm_set1_epi8('0')), _mm_set1_epi8(0xFE)
 			)
+		) break;
+	#else
+		const __m128i Binary = _mm_cmpeq_epi8(
+			_mm_and_si128(ASCII, _mm_set1_epi8(0xFE)), _mm_set1_epi8('0')
 		);
-		const __mmask64 Binary = _mm512_test_epi8_mask(
-			ASCII, _mm512_set1_epi8(0x01)
-		);
-		*reinterpret_cast<std::uint64_t*>(&Output[i]) = _cvtmask64_u64(Binary);
+		if( _mm_movemask_epi8(Binary) != 0xFFFF ) break;
+	#endif
+		Decode<1>(Input + i, Output + i, 2);
 	}
 
-	Decode<2>(Input + i * 8, Output + i * 8, Length % 8);
+	return i * 8 + DecodeChecked<0>(Input + i, Output + i, Length - i);
 }
 #endif
+
+// Four at a time
+#if defined(__AVX2__)
+template<>
+inline std::size_t DecodeChecked<2>(
+	const std::uint64_t Input[], std::uint8_t Output[], std::size_t Length
+)
+{
+	std::size_t i = 0;
+	for( ; i + 3 < Length; i += 4 )
+	{
+		const __m256i ASCII = _mm256_loadu_si256(
+			reinterpret_cast<const __m256i*>(&Input[i])
+		);
+		// Any bits other than the lowest differing from `0` are invalid
+		if(
+			!_mm256_testz_si256(
+				_mm256_xor_si256(ASCII, _mm256_set1_epi8('0')),
+				_mm256_set1_epi8(0xFE)
+			)
+		) break;
+		*reinterpret_cast<std::uint32_t*>(&Output[i]) = Decode4(ASCII);
+	}
+
+	return i * 8 + DecodeChecked<1>(Input + i, Output + i, Length - i);
 }
+#endif
 
-void Base2::Decode(
+// Eight at a time
+#if defined(__AVX512F__) && defined(__AVX512BW__)
+template<>
+inline std::size_t DecodeChecked<3>(
 	const std::uint64_t Input[], std::uint8_t Output[], std::size_t Length
 )
 {
-	::Decode<0xFFu>(Input, Output, Length);
+	std::size_t i = 0;
+	for( ; i + 7 < Length; i += 8 )
+	{
+		const __m512i ASCII = _mm512_loadu_si512(
+			reinterpret_cast<const __m512i*>(&Input[i])
+		);
+		// Any bits other than the lowest differing from `0` are invalid
+		const __mmask64 Invalid = _mm512_test_epi8_mask(
+			_mm512_xor_si512(ASCII, _mm512_set1_epi8('0')),
+			_mm512_set1_epi8(0xFE)
+		);
+		if( _cvtmask64_u64(Invalid) ) break;
+		*reinterpret_cast<std::uint64_t*>(&Output[i]) = Decode8(ASCII);
+	}
+
+	return i * 8 + DecodeChecked<2>(Input + i, Output + i, Length - i);
+}
+#endif
 }
 
 /// Filtering
 
-std::size_t Base2::Filter(std::uint8_t Bytes[], std::size_t Length)
+namespace
+{
+
+std::size_t Filter(std::uint8_t Bytes[], std::size_t Length)
 {
 	std::size_t End = 0;
 	std::size_t i = 0;
@@ -564,3 +1082,236 @@ std::size_t Base2::Filter(std::uint8_t Bytes[], std::size_t Length)
 	}
 	return End;
 }
+
+}
+
+/// Fused filtering and decoding
+
+namespace
+{
+
+#if defined(__BMI2__) && defined(__AVX2__)
+// Reverses the order of the bits within each byte
+inline std::uint64_t ReverseBits8( std::uint64_t Bytes )
+{
+	Bytes = ((Bytes >> 1) & 0x5555555555555555UL)
+		| ((Bytes & 0x5555555555555555UL) << 1);
+	Bytes = ((Bytes >> 2) & 0x3333333333333333UL)
+		| ((Bytes & 0x3333333333333333UL) << 2);
+	Bytes = ((Bytes >> 4) & 0x0F0F0F0F0F0F0F0FUL)
+		| ((Bytes & 0x0F0F0F0F0F0F0F0FUL) << 4);
+	return Bytes;
+}
+
+// Reverses the order of the bits within each byte of an array, using a table
+// of the reversed value of each nibble
+inline void ReverseBits8( std::uint8_t Bytes[], std::size_t Length )
+{
+	const __m256i ReverseNibble = _mm256_setr_epi8(
+		0x0, 0x8, 0x4, 0xC, 0x2, 0xA, 0x6, 0xE,
+		0x1, 0x9, 0x5, 0xD, 0x3, 0xB, 0x7, 0xF,
+		0x0, 0x8, 0x4, 0xC, 0x2, 0xA, 0x6, 0xE,
+		0x1, 0x9, 0x5, 0xD, 0x3, 0xB, 0x7, 0xF
+	);
+	std::size_t i = 0;
+	for( ; i + 31 < Length; i += 32 )
+	{
+		const __m256i Word256 = _mm256_loadu_si256(
+			reinterpret_cast<const __m256i*>(Bytes + i)
+		);
+		const __m256i Low = _mm256_shuffle_epi8(
+			ReverseNibble, _mm256_and_si256(Word256, _mm256_set1_epi8(0x0F))
+		);
+		const __m256i High = _mm256_shuffle_epi8(
+			ReverseNibble,
+			_mm256_and_si256(
+				_mm256_srli_epi16(Word256, 4), _mm256_set1_epi8(0x0F)
+			)
+		);
+		_mm256_storeu_si256(
+			reinterpret_cast<__m256i*>(Bytes + i),
+			_mm256_or_si256(_mm256_slli_epi16(Low, 4), High)
+		);
+	}
+	for( ; i < Length; ++i )
+	{
+		Bytes[i] = static_cast<std::uint8_t>(ReverseBits8(Bytes[i]));
+	}
+}
+
+// The digits within 64 bytes of input are given as a mask of the valid digits
+// and a mask of the `1` digits. The valid digits are compressed together and
+// appended to the `Pending` digits, in stream order starting from the lowest
+// bit, and every complete set of 64 digits is stored as 8 bytes. The first
+// digit of each stored byte is in its lowest bit, and is put into place
+// afterwards by `ReverseBits8`.
+inline void PackDigits(
+	std::uint64_t Valid, std::uint64_t Ones,
+	std::uint64_t& Pending, std::size_t& PendingCount, std::uint8_t*& Output
+)
+{
+	const std::uint64_t Digits = Valid == ~0ULL ? Ones : _pext_u64(Ones, Valid);
+	const std::size_t DigitCount = __builtin_popcountll(Valid);
+	Pending |= Digits << PendingCount;
+	if( PendingCount + DigitCount < 64 )
+	{
+		PendingCount += DigitCount;
+		return;
+	}
+	std::memcpy(Output, &Pending, sizeof(Pending));
+	Output += 8;
+	Pending = PendingCount ? Digits >> (64 - PendingCount) : 0;
+	PendingCount = PendingCount + DigitCount - 64;
+}
+
+// Packs the digits of `Length` bytes of input, without reversing them
+inline void PackBlock(
+	const std::uint8_t Input[], std::size_t Length,
+	std::uint64_t& Pending, std::size_t& PendingCount, std::uint8_t*& Output
+)
+{
+	std::size_t i = 0;
+	#if defined(__AVX512F__) && defined(__AVX512BW__)
+	// Check 64 bytes at a time
+	for( ; i + 63 < Length; i += 64 )
+	{
+		const __m512i Word512 = _mm512_loadu_si512(
+			reinterpret_cast<const __m512i*>(Input + i)
+		);
+		const __mmask64 Valid = _mm512_cmpeq_epi8_mask(
+			_mm512_and_si512(Word512, _mm512_set1_epi8(0xFE)),
+			_mm512_set1_epi8('0')
+		);
+		const __mmask64 Ones = _mm512_cmpeq_epi8_mask(
+			Word512, _mm512_set1_epi8('1')
+		);
+		PackDigits(
+			_cvtmask64_u64(Valid), _cvtmask64_u64(Ones),
+			Pending, PendingCount, Output
+		);
+	}
+	// The remaining bytes are loaded as zeros, which are never valid
+	if( i < Length )
+	{
+		const __m512i Word512 = _mm512_maskz_loadu_epi8(
+			_cvtu64_mask64(_bzhi_u64(~0ULL, Length - i)), Input + i
+		);
+		const __mmask64 Valid = _mm512_cmpeq_epi8_mask(
+			_mm512_and_si512(Word512, _mm512_set1_epi8(0xFE)),
+			_mm512_set1_epi8('0')
+		);
+		const __mmask64 Ones = _mm512_cmpeq_epi8_mask(
+			Word512, _mm512_set1_epi8('1')
+		);
+		PackDigits(
+			_cvtmask64_u64(Valid), _cvtmask64_u64(Ones),
+			Pending, PendingCount, Output
+		);
+	}
+	#else
+	// Check 64 bytes at a time, 32 bytes per half
+	for( ; i + 63 < Length; i += 64 )
+	{
+		std::uint64_t Valid = 0;
+		std::uint64_t Ones = 0;
+		for( std::size_t Half = 0; Half < 2; ++Half )
+		{
+			const __m256i Word256 = _mm256_loadu_si256(
+				reinterpret_cast<const __m256i*>(Input + i + Half * 32)
+			);
+			const std::uint32_t ValidHalf = _mm256_movemask_epi8(
+				_mm256_cmpeq_epi8(
+					_mm256_and_si256(Word256, _mm256_set1_epi8(0xFE)),
+					_mm256_set1_epi8('0')
+				)
+			);
+			const std::uint32_t OnesHalf = _mm256_movemask_epi8(
+				_mm256_cmpeq_epi8(Word256, _mm256_set1_epi8('1'))
+			);
+			Valid |= std::uint64_t(ValidHalf) << (Half * 32);
+			Ones |= std::uint64_t(OnesHalf) << (Half * 32);
+		}
+		PackDigits(Valid, Ones, Pending, PendingCount, Output);
+	}
+	if( i < Length )
+	{
+		std::uint64_t Valid = 0;
+		std::uint64_t Ones = 0;
+		for( std::size_t k = 0; i + k < Length; ++k )
+		{
+			const std::uint8_t CurByte = Input[i + k];
+			Valid |= std::uint64_t((CurByte & 0xFE) == 0x30) << k;
+			Ones |= std::uint64_t(CurByte == '1') << k;
+		}
+		PackDigits(Valid, Ones, Pending, PendingCount, Output);
+	}
+	#endif
+}
+
+std::size_t FilterDecode(
+	const std::uint8_t Input[], std::uint8_t Output[], std::size_t Length,
+	Base2::DecodeCarry& Carry
+)
+{
+	const std::uint8_t* OutputStart = Output;
+	std::uint64_t Pending = Carry.Digits;
+	std::size_t PendingCount = Carry.Count;
+
+	// The bytes of each block are reversed while they are still in the cache
+	for( std::size_t i = 0; i < Length; i += FilterBlockSize )
+	{
+		std::uint8_t* BlockOutput = Output;
+		PackBlock(
+			Input + i, std::min(FilterBlockSize, Length - i),
+			Pending, PendingCount, Output
+		);
+		ReverseBits8(BlockOutput, Output - BlockOutput);
+	}
+
+	// Store the remaining complete bytes and carry the rest
+	std::uint8_t* BlockOutput = Output;
+	for( ; PendingCount >= 8; PendingCount -= 8, Pending >>= 8 )
+	{
+		*Output++ = static_cast<std::uint8_t>(Pending);
+	}
+	ReverseBits8(BlockOutput, Output - BlockOutput);
+	Carry.Digits = static_cast<std::uint8_t>(Pending);
+	Carry.Count = static_cast<std::uint8_t>(PendingCount);
+	return Output - OutputStart;
+}
+#else
+std::size_t FilterDecode(
+	const std::uint8_t Input[], std::uint8_t Output[], std::size_t Length,
+	Base2::DecodeCarry& Carry
+)
+{
+	return FilterDecodeStaged(
+		::Filter, ::Decode<0xFFu>, Input, Output, Length, Carry
+	);
+}
+#endif
+
+}
+
+/// Line-wrapped decoding
+
+namespace
+{
+
+std::size_t DecodeWrapped(
+	const std::uint8_t Input[], std::uint8_t Output[], std::size_t Length,
+	std::size_t WrapWidth, Base2::DecodeCarry& Carry
+)
+{
+	return DecodeWrappedStaged(
+		::DecodeChecked<0xFFu>, ::FilterDecode, Input, Output, Length, WrapWidth, Carry
+	);
+}
+
+}
+
+const Base2::Kernels::Table Base2::Kernels::BASE2_TIER = {
+	::Encode<0xFFu>, ::Decode<0xFFu>, ::Filter, ::EncodeWrapped,
+	::FilterDecode, ::DecodeChecked<0xFFu>, ::DecodeWrapped,
+	::EncodeNonTemporal, ::EncodeFormatted
+};
@@ -1,69 +1,491 @@
 #include <Base2.hpp>
 
+#include <array>
+#include <atomic>
+#include <cctype>
+#include <cstdlib>
+
+#if defined(__unix__)
+#include <unistd.h>
+#endif
+
+#include "Base2-Kernels.hpp"
+
+/// Dispatch
+
+namespace
+{
+
+constexpr std::size_t IsaCount = static_cast<std::size_t>(Base2::Isa::NEON) + 1;
+
+const char* const IsaNames[IsaCount] = {
+	"auto", "generic", "sse41", "avx2", "avx512bw", "avx512bitalg",
+	"sse41gfni", "avx2gfni", "avx512gfni", "neon"
+};
+
+// Kernels of each tier that the running processor supports, with the widest
+// of them standing in for `Isa::Auto`. Null for any other tier.
+const std::array<const Base2::Kernels::Table*, IsaCount>& SupportedTables()
+{
+	static const std::array<const Base2::Kernels::Table*, IsaCount> Tables = []
+	{
+		std::array<const Base2::Kernels::Table*, IsaCount> Tables = {};
+		for( const Base2::Kernels::Tier& Tier : Base2::Kernels::SupportedTiers() )
+		{
+			Tables[static_cast<std::size_t>(Tier.Isa)] = Tier.Kernels;
+			Tables[static_cast<std::size_t>(Base2::Isa::Auto)] = Tier.Kernels;
+		}
+		return Tables;
+	}();
+	return Tables;
+}
+
+// The widest tier that the running processor supports, unless `BASE2_ISA`
+// names another supported tier
+Base2::Isa DefaultIsa()
+{
+	Base2::Isa Tier = Base2::Isa::Auto;
+	const char* Name = std::getenv("BASE2_ISA");
+	if(
+		Name != nullptr && Base2::ParseIsa(Name, Tier) && Tier != Base2::Isa::Auto
+		&& Base2::IsaSupported(Tier)
+	)
+	{
+		return Tier;
+	}
+	return Base2::Kernels::SupportedTiers().back().Isa;
+}
+
+// Tier that the entry points have been resolved to, `Isa::Auto` until then
+std::atomic<Base2::Isa> CurrentIsa{Base2::Isa::Auto};
+
+// Picks the tier of kernels for the entry points, upon the first call of any
+// of them
+const Base2::Kernels::Table& SelectKernels()
+{
+	Base2::Isa Tier = CurrentIsa.load(std::memory_order_relaxed);
+	if( Tier == Base2::Isa::Auto )
+	{
+		Tier = DefaultIsa();
+		CurrentIsa.store(Tier, std::memory_order_relaxed);
+	}
+	return *SupportedTables()[static_cast<std::size_t>(Tier)];
+}
+
+// Each entry point starts out pointing at a resolver that selects the kernel
+// upon the first call and then replaces itself, so that every call after that
+// is a single indirect call into the selected kernel
+void EncodeResolve(
+	const std::uint8_t Input[], std::uint64_t Output[], std::size_t Length
+);
+void DecodeResolve(
+	const std::uint64_t Input[], std::uint8_t Output[], std::size_t Length
+);
+std::size_t FilterResolve(std::uint8_t Bytes[], std::size_t Length);
+std::size_t EncodeWrappedResolve(
+	const std::uint8_t Input[], char Output[], std::size_t Length,
+	std::size_t WrapWidth, std::size_t Column
+);
+std::size_t FilterDecodeResolve(
+	const std::uint8_t Input[], std::uint8_t Output[], std::size_t Length,
+	Base2::DecodeCarry& Carry
+);
+std::size_t DecodeCheckedResolve(
+	const std::uint64_t Input[], std::uint8_t Output[], std::size_t Length
+);
+std::size_t DecodeWrappedResolve(
+	const std::uint8_t Input[], std::uint8_t Output[], std::size_t Length,
+	std::size_t WrapWidth, Base2::DecodeCarry& Carry
+);
+void EncodeNonTemporalResolve(
+	const std::uint8_t Input[], std::uint64_t Output[], std::size_t Length
+);
+std::size_t EncodeFormattedResolve(
+	const std::uint8_t Input[], char Output[], std::size_t Length,
+	const Base2::Kernels::FormatRecord& Record, std::uint64_t Position
+);
+
+std::atomic<Base2::Kernels::EncodeFunc> EncodeKernel{EncodeResolve};
+std::atomic<Base2::Kernels::DecodeFunc> DecodeKernel{DecodeResolve};
+std::atomic<Base2::Kernels::FilterFunc> FilterKernel{FilterResolve};
+std::atomic<Base2::Kernels::EncodeWrappedFunc> EncodeWrappedKernel{
+	EncodeWrappedResolve
+};
+std::atomic<Base2::Kernels::FilterDecodeFunc> FilterDecodeKernel{
+	FilterDecodeResolve
+};
+std::atomic<Base2::Kernels::DecodeCheckedFunc> DecodeCheckedKernel{
+	DecodeCheckedResolve
+};
+std::atomic<Base2::Kernels::DecodeWrappedFunc> DecodeWrappedKernel{
+	DecodeWrappedResolve
+};
+std::atomic<Base2::Kernels::EncodeFunc> EncodeNonTemporalKernel{
+	EncodeNonTemporalResolve
+};
+std::atomic<Base2::Kernels::EncodeFormattedFunc> EncodeFormattedKernel{
+	EncodeFormattedResolve
+};
+
+void EncodeResolve(
+	const std::uint8_t Input[], std::uint64_t Output[], std::size_t Length
+)
+{
+	const Base2::Kernels::EncodeFunc Kernel = SelectKernels().Encode;
+	EncodeKernel.store(Kernel, std::memory_order_relaxed);
+	Kernel(Input, Output, Length);
+}
+
+void DecodeResolve(
+	const std::uint64_t Input[], std::uint8_t Output[], std::size_t Length
+)
+{
+	const Base2::Kernels::DecodeFunc Kernel = SelectKernels().Decode;
+	DecodeKernel.store(Kernel, std::memory_order_relaxed);
+	Kernel(Input, Output, Length);
+}
+
+std::size_t FilterResolve(std::uint8_t Bytes[], std::size_t Length)
+{
+	const Base2::Kernels::FilterFunc Kernel = SelectKernels().Filter;
+	FilterKernel.store(Kernel, std::memory_order_relaxed);
+	return Kernel(Bytes, Length);
+}
+
+std::size_t EncodeWrappedResolve(
+	const std::uint8_t Input[], char Output[], std::size_t Length,
+	std::size_t WrapWidth, std::size_t Column
+)
+{
+	const Base2::Kernels::EncodeWrappedFunc Kernel
+		= SelectKernels().EncodeWrapped;
+	EncodeWrappedKernel.store(Kernel, std::memory_order_relaxed);
+	return Kernel(Input, Output, Length, WrapWidth, Column);
+}
+
+std::size_t FilterDecodeResolve(
+	const std::uint8_t Input[], std::uint8_t Output[], std::size_t Length,
+	Base2::DecodeCarry& Carry
+)
+{
+	const Base2::Kernels::FilterDecodeFunc Kernel
+		= SelectKernels().FilterDecode;
+	FilterDecodeKernel.store(Kernel, std::memory_order_relaxed);
+	return Kernel(Input, Output, Length, Carry);
+}
+
+std::size_t DecodeCheckedResolve(
+	const std::uint64_t Input[], std::uint8_t Output[], std::size_t Length
+)
+{
+	const Base2::Kernels::DecodeCheckedFunc Kernel
+		= SelectKernels().DecodeChecked;
+	DecodeCheckedKernel.store(Kernel, std::memory_order_relaxed);
+	return Kernel(Input, Output, Length);
+}
+
+std::size_t DecodeWrappedResolve(
+	const std::uint8_t Input[], std::uint8_t Output[], std::size_t Length,
+	std::size_t WrapWidth, Base2::DecodeCarry& Carry
+)
+{
+	const Base2::Kernels::DecodeWrappedFunc Kernel
+		= SelectKernels().DecodeWrapped;
+	DecodeWrappedKernel.store(Kernel, std::memory_order_relaxed);
+	return Kernel(Input, Output, Length, WrapWidth, Carry);
+}
+
+void EncodeNonTemporalResolve(
+	const std::uint8_t Input[], std::uint64_t Output[], std::size_t Length
+)
+{
+	const Base2::Kernels::EncodeFunc Kernel = SelectKernels().EncodeNonTemporal;
+	EncodeNonTemporalKernel.store(Kernel, std::memory_order_relaxed);
+	Kernel(Input, Output, Length);
+}
+
+std::size_t EncodeFormattedResolve(
+	const std::uint8_t Input[], char Output[], std::size_t Length,
+	const Base2::Kernels::FormatRecord& Record, std::uint64_t Position
+)
+{
+	const Base2::Kernels::EncodeFormattedFunc Kernel
+		= SelectKernels().EncodeFormatted;
+	EncodeFormattedKernel.store(Kernel, std::memory_order_relaxed);
+	return Kernel(Input, Output, Length, Record, Position);
+}
+
+// Outputs that do not fit within the L2 cache are written no faster through
+// it, and only evict the working sets of everything else on the core
+std::size_t DefaultNonTemporalThreshold()
+{
+	long CacheSize = 0;
+#if defined(_SC_LEVEL2_CACHE_SIZE)
+	CacheSize = sysconf(_SC_LEVEL2_CACHE_SIZE);
+#endif
+	if( CacheSize <= 0 )
+	{
+		CacheSize = 1024 * 1024;
+	}
+	return static_cast<std::size_t>(CacheSize);
+}
+
+std::atomic<std::size_t>& NonTemporalBytes()
+{
+	static std::atomic<std::size_t> Bytes{DefaultNonTemporalThreshold()};
+	return Bytes;
+}
+
+}
+
+std::vector<Base2::Kernels::Tier> Base2::Kernels::SupportedTiers()
+{
+	std::vector<Tier> Tiers;
 #if defined(__x86_64__) || defined(_M_X64)
-#include "Base2-x86.hpp"
+	__builtin_cpu_init();
+	const bool HasBMI2 = __builtin_cpu_supports("bmi2");
+	const bool HasAVX512BW = HasBMI2 && __builtin_cpu_supports("avx512f")
+		&& __builtin_cpu_supports("avx512bw");
+	const bool HasGFNI = __builtin_cpu_supports("gfni");
+	Tiers.push_back({Base2::Isa::Generic, "Generic", &Generic});
+	if( __builtin_cpu_supports("sse4.1") )
+	{
+		Tiers.push_back({Base2::Isa::SSE41, "SSE41", &SSE41});
+		if( HasGFNI )
+		{
+			Tiers.push_back({Base2::Isa::SSE41GFNI, "SSE41GFNI", &SSE41GFNI});
+		}
+	}
+	if( HasBMI2 && __builtin_cpu_supports("avx2") )
+	{
+		Tiers.push_back({Base2::Isa::AVX2, "AVX2", &AVX2});
+		if( HasGFNI )
+		{
+			Tiers.push_back({Base2::Isa::AVX2GFNI, "AVX2GFNI", &AVX2GFNI});
+		}
+	}
+	if( HasAVX512BW )
+	{
+		Tiers.push_back({Base2::Isa::AVX512BW, "AVX512BW", &AVX512BW});
+		if( HasGFNI )
+		{
+			Tiers.push_back({Base2::Isa::AVX512GFNI, "AVX512GFNI", &AVX512GFNI});
+		}
+	}
+	if(
+		HasAVX512BW && __builtin_cpu_supports("avx512bitalg")
+		&& __builtin_cpu_supports("avx512vbmi2")
+	)
+	{
+		Tiers.push_back({Base2::Isa::AVX512BITALG, "AVX512BITALG", &AVX512BITALG});
+	}
 #elif defined(__aarch64__) || defined(_M_ARM64)
-#include "Base2-arm64.hpp"
+	Tiers.push_back({Base2::Isa::NEON, "NEON", &NEON});
 #else
-// Generic Implementation
+	Tiers.push_back({Base2::Isa::Generic, "Generic", &Generic});
+#endif
+	return Tiers;
+}
+
+bool Base2::IsaSupported(Isa Tier)
+{
+	const std::size_t Index = static_cast<std::size_t>(Tier);
+	return Index < IsaCount && SupportedTables()[Index] != nullptr;
+}
+
+const char* Base2::IsaName(Isa Tier)
+{
+	const std::size_t Index = static_cast<std::size_t>(Tier);
+	return Index < IsaCount ? IsaNames[Index] : "unknown";
+}
+
+bool Base2::ParseIsa(const char* Name, Isa& Tier)
+{
+	for( std::size_t i = 0; i < IsaCount; ++i )
+	{
+		const char* Expected = IsaNames[i];
+		std::size_t k = 0;
+		while(
+			Name[k] && Expected[k]
+			&& std::tolower(static_cast<unsigned char>(Name[k])) == Expected[k]
+		)
+		{
+			++k;
+		}
+		if( Name[k] == '\0' && Expected[k] == '\0' )
+		{
+			Tier = static_cast<Isa>(i);
+			return true;
+		}
+	}
+	return false;
+}
+
+Base2::Isa Base2::SelectedIsa()
+{
+	SelectKernels();
+	return CurrentIsa.load(std::memory_order_relaxed);
+}
+
+bool Base2::SelectIsa(Isa Tier)
+{
+	if( !IsaSupported(Tier) )
+	{
+		return false;
+	}
+	if( Tier == Isa::Auto )
+	{
+		Tier = DefaultIsa();
+	}
+	const Kernels::Table& Kernels = *SupportedTables()[static_cast<std::size_t>(Tier)];
+	CurrentIsa.store(Tier, std::memory_order_relaxed);
+	EncodeKernel.store(Kernels.Encode, std::memory_order_relaxed);
+	DecodeKernel.store(Kernels.Decode, std::memory_order_relaxed);
+	FilterKernel.store(Kernels.Filter, std::memory_order_relaxed);
+	EncodeWrappedKernel.store(Kernels.EncodeWrapped, std::memory_order_relaxed);
+	FilterDecodeKernel.store(Kernels.FilterDecode, std::memory_order_relaxed);
+	DecodeCheckedKernel.store(Kernels.DecodeChecked, std::memory_order_relaxed);
+	DecodeWrappedKernel.store(Kernels.DecodeWrapped, std::memory_order_relaxed);
+	EncodeNonTemporalKernel.store(
+		Kernels.EncodeNonTemporal, std::memory_order_relaxed
+	);
+	EncodeFormattedKernel.store(
+		Kernels.EncodeFormatted, std::memory_order_relaxed
+	);
+	return true;
+}
+
 void Base2::Encode(
 	const std::uint8_t Input[], std::uint64_t Output[], std::size_t Length
 )
 {
-	// Least significant bit in an 8-bit integer
-	constexpr std::uint64_t LSB8       = 0x0101010101010101UL;
-	// Each byte has a unique bit set
-	constexpr std::uint64_t UniqueBit  = 0x0102040810204080UL;
-	// Shifts unique bits to the left, using the carry of binary addition
-	constexpr std::uint64_t CarryShift = 0x7F7E7C7870604000UL;
-	// Most significant bit in an 8-bit integer
-	constexpr std::uint64_t MSB8       = LSB8 << 7u;
-	// Constant bits for ascii '0' and '1'
-	constexpr std::uint64_t BinAsciiBasis = LSB8 * '0';
-	for( std::size_t i = 0; i < Length; ++i )
+	if( Length > NonTemporalBytes().load(std::memory_order_relaxed) / 8 )
 	{
-		Output[i] = ((((((
-			static_cast<std::uint64_t>(Input[i])
-			* LSB8			) // "broadcast" low byte to all 8 bytes.
-			& UniqueBit		) // Mask each byte to have 1 unique bit.
-			+ CarryShift	) // Shift this bit to the last bit of each
-							  // byte using the carry of binary addition.
-			& MSB8			) // Isolate these last bits of each byte.
-			>> 7			) // Shift it back to the low bit of each byte.
-			| BinAsciiBasis	  // Turn it into ascii '0' and '1'
-		);
+		EncodeNonTemporal(Input, Output, Length);
+		return;
 	}
+	EncodeKernel.load(std::memory_order_relaxed)(Input, Output, Length);
 }
 
-void Base2::Decode(
-	const std::uint64_t Input[], std::uint8_t Output[], std::size_t Length
+void Base2::Encode(
+	const std::uint8_t Input[], std::uint64_t Output[], std::size_t Length,
+	Isa Tier
 )
 {
-	for( std::size_t i = 0; i < Length; ++i )
+	if( Tier != Isa::Auto && IsaSupported(Tier) )
 	{
-		std::uint8_t Binary = 0;
-		std::uint64_t Mask = 0x0101010101010101UL;
-		for( std::uint64_t CurBit = 1UL; Mask != 0; CurBit <<= 1 )
+		const Kernels::Table& Kernels
+			= *SupportedTables()[static_cast<std::size_t>(Tier)];
+		if( Length > NonTemporalBytes().load(std::memory_order_relaxed) / 8 )
 		{
-			if( __builtin_bswap64(Input[i]) & Mask & -Mask )
-			{
-				Binary |= CurBit;
-			}
-			Mask &= (Mask - 1UL);
+			Kernels.EncodeNonTemporal(Input, Output, Length);
+			return;
 		}
-		Output[i] = Binary;
+		Kernels.Encode(Input, Output, Length);
+		return;
 	}
+	Encode(Input, Output, Length);
 }
 
-std::size_t Base2::Filter(std::uint8_t Bytes[], std::size_t Length)
+void Base2::EncodeNonTemporal(
+	const std::uint8_t Input[], std::uint64_t Output[], std::size_t Length
+)
+{
+	EncodeNonTemporalKernel.load(std::memory_order_relaxed)(
+		Input, Output, Length
+	);
+}
+
+std::size_t Base2::NonTemporalThreshold()
 {
-	std::size_t End = 0;
-	for( std::size_t i = 0; i < Length; ++i )
+	return NonTemporalBytes().load(std::memory_order_relaxed);
+}
+
+void Base2::SetNonTemporalThreshold(std::size_t Bytes)
+{
+	NonTemporalBytes().store(Bytes, std::memory_order_relaxed);
+}
+
+void Base2::Decode(
+	const std::uint64_t Input[], std::uint8_t Output[], std::size_t Length
+)
+{
+	DecodeKernel.load(std::memory_order_relaxed)(Input, Output, Length);
+}
+
+void Base2::Decode(
+	const std::uint64_t Input[], std::uint8_t Output[], std::size_t Length,
+	Isa Tier
+)
+{
+	if( Tier != Isa::Auto && IsaSupported(Tier) )
 	{
-		const std::uint8_t CurByte = Bytes[i];
-		if( (CurByte & 0b11111110) != 0x30 ) continue;
-		Bytes[End++] = CurByte;
+		SupportedTables()[static_cast<std::size_t>(Tier)]->Decode(
+			Input, Output, Length
+		);
+		return;
 	}
-	return End;
+	Decode(Input, Output, Length);
+}
+
+std::size_t Base2::Filter(std::uint8_t Bytes[], std::size_t Length)
+{
+	return FilterKernel.load(std::memory_order_relaxed)(Bytes, Length);
+}
+
+std::size_t Base2::EncodeWrapped(
+	const std::uint8_t Input[], char Output[], std::size_t Length,
+	std::size_t WrapWidth, std::size_t Column
+)
+{
+	return EncodeWrappedKernel.load(std::memory_order_relaxed)(
+		Input, Output, Length, WrapWidth, Column
+	);
+}
+
+std::size_t Base2::FormattedEncoder::Encode(
+	const std::uint8_t Input[], char Output[], std::size_t Length,
+	std::uint64_t Position
+) const
+{
+	return EncodeFormattedKernel.load(std::memory_order_relaxed)(
+		Input, Output, Length, *Record, Position
+	);
+}
+
+std::size_t Base2::EncodeFormatted(
+	const std::uint8_t Input[], char Output[], std::size_t Length,
+	const Format& Format, std::uint64_t Position
+)
+{
+	return FormattedEncoder(Format).Encode(Input, Output, Length, Position);
+}
+
+std::size_t Base2::FilterDecode(
+	const std::uint8_t Input[], std::uint8_t Output[], std::size_t Length,
+	DecodeCarry& Carry
+)
+{
+	return FilterDecodeKernel.load(std::memory_order_relaxed)(
+		Input, Output, Length, Carry
+	);
+}
+
+std::size_t Base2::DecodeChecked(
+	const std::uint64_t Input[], std::uint8_t Output[], std::size_t Length
+)
+{
+	return DecodeCheckedKernel.load(std::memory_order_relaxed)(
+		Input, Output, Length
+	);
+}
+
+std::size_t Base2::DecodeWrapped(
+	const std::uint8_t Input[], std::uint8_t Output[], std::size_t Length,
+	std::size_t WrapWidth, DecodeCarry& Carry
+)
+{
+	return DecodeWrappedKernel.load(std::memory_order_relaxed)(
+		Input, Output, Length, WrapWidth, Carry
+	);
 }
-#endif
@@ -1,18 +1,190 @@
+#include <cerrno>
+#include <cinttypes>
 #include <cstddef>
 #include <cstdint>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
 #include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
 #include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <time.h>
 #include <unistd.h>
 #include <getopt.h>
+#if defined(BASE2_HAVE_LIBURING)
+#include <liburing.h>
+#endif
 
 #include <Base2.hpp>
 
 // Virtual page size of the current system
-const static std::size_t ByteBuffSize = sysconf(_SC_PAGE_SIZE);
-const static std::size_t AsciiBuffSize = ByteBuffSize * 8;
+const static std::size_t PageSize = sysconf(_SC_PAGE_SIZE);
+// Size of a huge page, for buffers that are large enough to use them
+const static std::size_t HugePageSize = 2 * 1024 * 1024;
+// Requested capacity of an output pipe when splicing into it
+const static std::size_t PipeBuffSize = 1024 * 1024;
+
+// Time spent in each phase of transcoding along with the amount of data
+// processed, gathered for `--stats`. Phases may run on separate threads at the
+// same time, so every counter is atomic.
+struct TranscodeStats
+{
+	enum Phase : std::size_t
+	{
+		// Reading input into a buffer
+		Read,
+		// Running the kernels
+		Transcode,
+		// Writing or splicing output
+		Write,
+		// Waiting upon the completion of asynchronous reads and writes
+		Wait,
+		PhaseCount
+	};
+
+	// System calls that the transcoding paths make directly upon each batch.
+	// Reads and writes through stdio are counted by the kernel instead, see
+	// `ProcessIo`.
+	enum Syscall : std::size_t
+	{
+		Vmsplice,
+		UringSubmit,
+		Madvise,
+		SyscallCount
+	};
+
+	static std::uint64_t Now( clockid_t Clock )
+	{
+		timespec Time;
+		clock_gettime(Clock, &Time);
+		return std::uint64_t(Time.tv_sec) * 1000000000 + Time.tv_nsec;
+	}
+
+	std::atomic<std::uint64_t> WallNs[PhaseCount] = {};
+	// CPU time of the thread that ran the phase
+	std::atomic<std::uint64_t> CpuNs[PhaseCount]  = {};
+	// Number of timed intervals of the phase, such as one for each batch
+	std::atomic<std::uint64_t> Intervals[PhaseCount] = {};
+	std::atomic<std::uint64_t> Syscalls[SyscallCount] = {};
+	std::atomic<std::uint64_t> BytesIn{0};
+	std::atomic<std::uint64_t> BytesOut{0};
+	// Bytes that were skipped by `--ignore-garbage` decoding
+	std::atomic<std::uint64_t> Garbage{0};
+	std::uint64_t StartNs = Now(CLOCK_MONOTONIC);
+	// CPU time and resource usage of the process before transcoding began
+	std::uint64_t StartCpuNs = Now(CLOCK_PROCESS_CPUTIME_ID);
+	rusage StartUsage = Usage();
+	// Read and write system calls of the process before transcoding began
+	std::uint64_t StartReads  = 0;
+	std::uint64_t StartWrites = 0;
+	const bool HasProcessIo = ProcessIo(StartReads, StartWrites);
+
+	static rusage Usage()
+	{
+		rusage Usage = {};
+		getrusage(RUSAGE_SELF, &Usage);
+		return Usage;
+	}
+
+	static double Seconds( const timeval& Start, const timeval& End )
+	{
+		return (End.tv_sec - Start.tv_sec) + (End.tv_usec - Start.tv_usec) * 1e-6;
+	}
+
+	// Number of read and write system calls the process has made so far, as
+	// counted by the kernel. Returns false where the kernel does not tell.
+	static bool ProcessIo( std::uint64_t& Reads, std::uint64_t& Writes )
+	{
+		std::FILE* Io = std::fopen("/proc/self/io", "r");
+		if( Io == nullptr )
+		{
+			return false;
+		}
+		char Line[64];
+		int Found = 0;
+		while( std::fgets(Line, sizeof(Line), Io) )
+		{
+			Found += std::sscanf(Line, "syscr: %" SCNu64, &Reads);
+			Found += std::sscanf(Line, "syscw: %" SCNu64, &Writes);
+		}
+		std::fclose(Io);
+		return Found == 2;
+	}
+};
+
+// Adds the time from its construction to its destruction to a phase of the
+// stats, if there are any
+class PhaseTimer
+{
+public:
+	PhaseTimer( TranscodeStats* Stats, TranscodeStats::Phase Phase )
+		: Stats(Stats), Phase(Phase)
+	{
+		if( Stats )
+		{
+			WallStart = TranscodeStats::Now(CLOCK_MONOTONIC);
+			CpuStart  = TranscodeStats::Now(CLOCK_THREAD_CPUTIME_ID);
+		}
+	}
+
+	~PhaseTimer()
+	{
+		if( Stats )
+		{
+			Stats->WallNs[Phase].fetch_add(
+				TranscodeStats::Now(CLOCK_MONOTONIC) - WallStart,
+				std::memory_order_relaxed
+			);
+			Stats->CpuNs[Phase].fetch_add(
+				TranscodeStats::Now(CLOCK_THREAD_CPUTIME_ID) - CpuStart,
+				std::memory_order_relaxed
+			);
+			Stats->Intervals[Phase].fetch_add(1, std::memory_order_relaxed);
+		}
+	}
+
+	PhaseTimer( const PhaseTimer& ) = delete;
+	PhaseTimer& operator=( const PhaseTimer& ) = delete;
+
+private:
+	TranscodeStats* Stats;
+	TranscodeStats::Phase Phase;
+	std::uint64_t WallStart = 0;
+	std::uint64_t CpuStart  = 0;
+};
+
+// Counts a system call in the stats, if there are any
+void CountSyscall( TranscodeStats* Stats, TranscodeStats::Syscall Syscall )
+{
+	if( Stats )
+	{
+		Stats->Syscalls[Syscall].fetch_add(1, std::memory_order_relaxed);
+	}
+}
+
+// Adds to one of the byte counters of the stats, if there are any
+void CountBytes(
+	TranscodeStats* Stats, std::atomic<std::uint64_t> TranscodeStats::* Counter,
+	std::uint64_t Bytes
+)
+{
+	if( Stats )
+	{
+		(Stats->*Counter).fetch_add(Bytes, std::memory_order_relaxed);
+	}
+}
+
+struct BatchBuffers;
 
 struct Settings
 {
@@ -20,158 +192,2082 @@ struct Settings
 	std::FILE* OutputFile = stdout;
 	bool Decode           = false;
 	bool IgnoreInvalid    = false;
+	bool Strict           = false;
 	std::size_t Wrap      = 76;
+	// `0` uses all hardware threads
+	std::size_t Threads   = 1;
+	// Bytes of binary data transcoded per batch, `0` sizes it to the cache
+	std::size_t BufferSize = 0;
+	// Range of the decoded output given by `--offset` and `--length`, which is
+	// all that is decoded when `DecodeRange` is set
+	bool DecodeRange       = false;
+	std::uint64_t RangeOffset = 0;
+	std::uint64_t RangeLength = UINT64_MAX;
+	// Layout given by `--prefix`, `--suffix`, `--separator`, and `--group`,
+	// which replaces the line-wrapping of `Wrap` when `Formatted` is set
+	bool Formatted         = false;
+	Base2::Format Format;
+	// Gathered when `--stats` is given
+	TranscodeStats* Stats  = nullptr;
+	// Buffers reused across files when transcoding many of them upon one
+	// thread, in which case each file is transcoded in sequence
+	BatchBuffers* Buffers  = nullptr;
+};
+
+std::size_t GetThreadCount( const Settings& Settings )
+{
+	return Settings.Threads ?
+		Settings.Threads : std::max(std::thread::hardware_concurrency(), 1u);
+}
+
+// Bytes of binary data to transcode per batch. By default each thread gets
+// a batch whose 8x larger ascii form fills a quarter of its L2 cache, leaving
+// the rest of it to the input and to the kernel's copy of the output.
+std::size_t GetBatchSize( const Settings& Settings )
+{
+	std::size_t BatchSize = Settings.BufferSize;
+	if( BatchSize == 0 )
+	{
+		long CacheSize = 0;
+	#if defined(_SC_LEVEL2_CACHE_SIZE)
+		CacheSize = sysconf(_SC_LEVEL2_CACHE_SIZE);
+	#endif
+		if( CacheSize <= 0 )
+		{
+			CacheSize = 1024 * 1024;
+		}
+		BatchSize = (CacheSize / 32) * GetThreadCount(Settings);
+	}
+	return std::max(BatchSize / PageSize * PageSize, PageSize);
+}
+
+// Page-aligned buffer of at least `Size` bytes. Buffers large enough are
+// backed by huge pages, either explicitly reserved ones or transparent ones,
+// and every buffer is pre-faulted so that the first batch does not pay for it.
+class PageBuffer
+{
+public:
+	explicit PageBuffer( std::size_t Size )
+	{
+	#if defined(MAP_HUGETLB)
+		if( Size >= HugePageSize )
+		{
+			const std::size_t HugeSize
+				= (Size + HugePageSize - 1) / HugePageSize * HugePageSize;
+			void* Mapping = mmap(
+				0, HugeSize, PROT_READ | PROT_WRITE,
+				MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | MAP_POPULATE, -1, 0
+			);
+			if( Mapping != MAP_FAILED )
+			{
+				Data = Mapping;
+				this->Size = HugeSize;
+				return;
+			}
+		}
+	#endif
+		// No huge pages are reserved, fall back to regular pages that may be
+		// merged into transparent huge pages
+		Size = (Size + PageSize - 1) / PageSize * PageSize;
+		void* Mapping = mmap(
+			0, Size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0
+		);
+		if( Mapping == MAP_FAILED )
+		{
+			return;
+		}
+	#if defined(MADV_HUGEPAGE)
+		if( Size >= HugePageSize )
+		{
+			madvise(Mapping, Size, MADV_HUGEPAGE);
+		}
+	#endif
+	#if defined(MADV_POPULATE_WRITE)
+		madvise(Mapping, Size, MADV_POPULATE_WRITE);
+	#endif
+		Data = Mapping;
+		this->Size = Size;
+	}
+
+	~PageBuffer()
+	{
+		if( Data )
+		{
+			munmap(Data, Size);
+		}
+	}
+
+	PageBuffer( const PageBuffer& ) = delete;
+	PageBuffer& operator=( const PageBuffer& ) = delete;
+
+	template<typename T>
+	T* Get() const
+	{
+		return static_cast<T*>(Data);
+	}
+
+	explicit operator bool() const
+	{
+		return Data != nullptr;
+	}
+
+private:
+	void* Data       = nullptr;
+	std::size_t Size = 0;
+};
+
+// Input and output buffers of a thread that transcodes one file after
+// another, only reallocated when a file needs larger batches
+struct BatchBuffers
+{
+	std::unique_ptr<PageBuffer> Input;
+	std::unique_ptr<PageBuffer> Output;
+	std::size_t InputSize  = 0;
+	std::size_t OutputSize = 0;
+
+	bool Reserve( std::size_t InputSize, std::size_t OutputSize )
+	{
+		if( InputSize > this->InputSize )
+		{
+			Input = std::make_unique<PageBuffer>(InputSize);
+			this->InputSize = *Input ? InputSize : 0;
+		}
+		if( OutputSize > this->OutputSize )
+		{
+			Output = std::make_unique<PageBuffer>(OutputSize);
+			this->OutputSize = *Output ? OutputSize : 0;
+		}
+		return this->InputSize && this->OutputSize;
+	}
+};
+
+// Memory-mapping of a regular input file, so that its contents may be read
+// straight out of the page cache rather than copied into a buffer
+struct InputMapping
+{
+	const std::uint8_t* Data = nullptr;
+	std::size_t Length       = 0;
+	// Page-aligned span of the mapping
+	std::uint8_t* Base       = nullptr;
+	std::size_t BaseSize     = 0;
+	// Bytes at the start of the mapping whose pages have been released
+	std::size_t Released     = 0;
+};
+
+bool MapInput( std::FILE* InputFile, InputMapping& Mapping )
+{
+	const int InputFD = fileno(InputFile);
+	struct stat InputStat;
+	if( fstat(InputFD, &InputStat) != 0 || !S_ISREG(InputStat.st_mode) )
+	{
+		return false;
+	}
+	// Start from the current position, such as when stdin is a file that has
+	// already been partially read
+	const off_t Position = lseek(InputFD, 0, SEEK_CUR);
+	if( Position < 0 || Position >= InputStat.st_size )
+	{
+		return false;
+	}
+	const std::size_t PageOffset = Position % PageSize;
+	Mapping.BaseSize = InputStat.st_size - Position + PageOffset;
+	void* Base = mmap(
+		0, Mapping.BaseSize, PROT_READ, MAP_PRIVATE, InputFD,
+		Position - PageOffset
+	);
+	if( Base == MAP_FAILED )
+	{
+		return false;
+	}
+	Mapping.Base   = static_cast<std::uint8_t*>(Base);
+	Mapping.Data   = Mapping.Base + PageOffset;
+	Mapping.Length = InputStat.st_size - Position;
+	// Hints for the kernel to read ahead aggressively and to back the mapping
+	// with huge pages where the filesystem supports it
+	madvise(Mapping.Base, Mapping.BaseSize, MADV_SEQUENTIAL);
+#if defined(MADV_HUGEPAGE)
+	madvise(Mapping.Base, Mapping.BaseSize, MADV_HUGEPAGE);
+#endif
+	return true;
+}
+
+// Drops the pages of the first `Consumed` bytes of the mapping, which will
+// not be read again
+void ReleaseInput(
+	InputMapping& Mapping, std::size_t Consumed, TranscodeStats* Stats
+)
+{
+	const std::size_t Release = (
+		(Mapping.Data - Mapping.Base) + Consumed
+	) / PageSize * PageSize;
+	if( Release > Mapping.Released )
+	{
+		madvise(
+			Mapping.Base + Mapping.Released, Release - Mapping.Released,
+			MADV_DONTNEED
+		);
+		CountSyscall(Stats, TranscodeStats::Madvise);
+		Mapping.Released = Release;
+	}
+}
+
+// Faults in the pages of the `Length` bytes at `Offset` within the mapping
+// all at once, rather than one at a time from within the kernels. This is
+// where a mapped input is read, and is timed as such.
+void ReadInput(
+	const InputMapping& Mapping, std::size_t Offset, std::size_t Length,
+	TranscodeStats* Stats
+)
+{
+#if defined(MADV_POPULATE_READ)
+	const PhaseTimer Timer(Stats, TranscodeStats::Read);
+	const std::size_t Start = (Mapping.Data - Mapping.Base) + Offset;
+	const std::size_t PageStart = Start / PageSize * PageSize;
+	madvise(
+		Mapping.Base + PageStart, Start + Length - PageStart, MADV_POPULATE_READ
+	);
+	CountSyscall(Stats, TranscodeStats::Madvise);
+#endif
+}
+
+// Calls `Process(Batch, Length)` upon consecutive batches of up to `BatchSize`
+// bytes of input until `Process` returns false or the input ends. Regular
+// files are memory-mapped and passed to `Process` directly, anything else is
+// read into `Buffer` first. Every batch but the last is `BatchSize` bytes.
+template<typename ProcessT>
+bool ReadBatches(
+	std::FILE* InputFile, std::uint8_t* Buffer, std::size_t BatchSize,
+	TranscodeStats* Stats, ProcessT&& Process
+)
+{
+	InputMapping Mapping;
+	if( MapInput(InputFile, Mapping) )
+	{
+		bool Result = true;
+		for( std::size_t Offset = 0; Offset < Mapping.Length; Offset += BatchSize )
+		{
+			const std::size_t Length = std::min(BatchSize, Mapping.Length - Offset);
+			ReadInput(Mapping, Offset, Length, Stats);
+			if( !Process(Mapping.Data + Offset, Length) )
+			{
+				Result = false;
+				break;
+			}
+			ReleaseInput(Mapping, Offset + Length, Stats);
+		}
+		munmap(Mapping.Base, Mapping.BaseSize);
+		return Result;
+	}
+
+	for( ;; )
+	{
+		std::size_t CurRead = 0;
+		{
+			const PhaseTimer Timer(Stats, TranscodeStats::Read);
+			CurRead = std::fread(Buffer, 1, BatchSize, InputFile);
+		}
+		if( CurRead == 0 ) break;
+		if( !Process(Buffer, CurRead) )
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+// Number of batches circulating between the reader, transcoder, and writer
+const static std::size_t PipelineDepth = 4;
+
+// Queue of batch indices passed from one pipeline stage to the next. There are
+// only ever `PipelineDepth` batches, so pushing never has to wait. Popping is
+// lock-free while batches are available, and otherwise spins for a moment
+// before sleeping until a batch is pushed or the queue is closed.
+class BatchQueue
+{
+public:
+	void Push( std::size_t Batch )
+	{
+		const std::size_t CurTail = Tail.load(std::memory_order_relaxed);
+		Batches[CurTail % PipelineDepth] = Batch;
+		Tail.store(CurTail + 1);
+		Notify();
+	}
+
+	// No more batches will be pushed
+	void Close()
+	{
+		Closed.store(true);
+		Notify();
+	}
+
+	// Returns false once the queue is closed and empty
+	bool Pop( std::size_t& Batch )
+	{
+		const std::size_t CurHead = Head.load(std::memory_order_relaxed);
+		if( !Wait(CurHead) )
+		{
+			return false;
+		}
+		Batch = Batches[CurHead % PipelineDepth];
+		Head.store(CurHead + 1, std::memory_order_relaxed);
+		return true;
+	}
+
+private:
+	// Iterations spent polling before sleeping, long enough to cover the
+	// hand-off between two busy stages
+	const static std::size_t SpinCount = 4096;
+
+	bool Wait( std::size_t CurHead )
+	{
+		for( std::size_t i = 0; i < SpinCount; ++i )
+		{
+			if( Tail.load(std::memory_order_acquire) != CurHead ) return true;
+			if( Closed.load(std::memory_order_acquire) ) break;
+		}
+		// `Sleeping` is set before checking the queue again, and `Push` and
+		// `Close` update the queue before checking `Sleeping`, so either this
+		// thread sees the batch or the pushing thread sees it sleeping
+		std::unique_lock<std::mutex> Lock(SleepLock);
+		Sleeping.store(true);
+		Wake.wait(
+			Lock, [&]{ return Tail.load() != CurHead || Closed.load(); }
+		);
+		Sleeping.store(false, std::memory_order_relaxed);
+		return Tail.load(std::memory_order_acquire) != CurHead;
+	}
+
+	void Notify()
+	{
+		if( Sleeping.load() )
+		{
+			const std::lock_guard<std::mutex> Lock(SleepLock);
+			Wake.notify_one();
+		}
+	}
+
+	std::size_t Batches[PipelineDepth] = {};
+	std::atomic<std::size_t> Head{0};
+	std::atomic<std::size_t> Tail{0};
+	std::atomic<bool> Closed{false};
+	std::atomic<bool> Sleeping{false};
+	std::mutex SleepLock;
+	std::condition_variable Wake;
 };
 
-std::size_t WrapWrite(
-	const char* Buffer, std::size_t Length, std::size_t WrapWidth,
-	std::FILE* OutputFile, std::size_t CurrentColumn = 0
+// A batch of input and the output that it was transcoded into
+struct PipelineBatch
+{
+	const std::uint8_t* Input = nullptr;
+	std::size_t InputLength   = 0;
+	// Offset of the end of the batch within the input
+	std::size_t InputEnd      = 0;
+	std::uint8_t* Output      = nullptr;
+	std::size_t OutputLength  = 0;
+};
+
+// Transcodes batches of up to `InputSize` bytes of input into up to
+// `OutputSize` bytes of output each. A reader thread reads batches ahead of
+// the transcoder and a writer thread writes them out behind it, so that
+// neither blocking on input nor on output holds up the kernels.
+// `Transcode(Batch, Length, Output, OutputLength)` is called upon each batch
+// in order on the calling thread, and returns false after reporting an error
+// to stop, in which case the `OutputLength` bytes before the error are still
+// written. Every batch but the last is `InputSize` bytes.
+template<typename TranscodeT>
+bool TranscodeBatches(
+	const Settings& Settings, std::size_t InputSize, std::size_t OutputSize,
+	TranscodeT&& Transcode
+)
+{
+	if( Settings.Buffers || std::thread::hardware_concurrency() < 2 )
+	{
+		// Without another processor to run on, the stages would only take
+		// turns, so each batch is read, transcoded, and written in sequence.
+		// The same goes for when the other processors are busy with files of
+		// their own.
+		BatchBuffers LocalBuffers;
+		BatchBuffers& Buffers = Settings.Buffers ? *Settings.Buffers : LocalBuffers;
+		if( !Buffers.Reserve(InputSize, OutputSize) )
+		{
+			std::fputs("Error allocating buffers", stderr);
+			return EXIT_FAILURE;
+		}
+		const PageBuffer& InputBuffer = *Buffers.Input;
+		const PageBuffer& OutputBuffer = *Buffers.Output;
+		bool Result = EXIT_SUCCESS;
+		ReadBatches(
+			Settings.InputFile, InputBuffer.Get<std::uint8_t>(), InputSize,
+			Settings.Stats,
+			[&](const std::uint8_t* Batch, std::size_t CurRead) -> bool
+			{
+				std::size_t OutputLength = 0;
+				bool Continue;
+				{
+					const PhaseTimer Timer(Settings.Stats, TranscodeStats::Transcode);
+					Continue = Transcode(
+						Batch, CurRead, OutputBuffer.Get<std::uint8_t>(), OutputLength
+					);
+				}
+				if( !Continue )
+				{
+					Result = EXIT_FAILURE;
+				}
+				CountBytes(Settings.Stats, &TranscodeStats::BytesIn, CurRead);
+				const PhaseTimer Timer(Settings.Stats, TranscodeStats::Write);
+				if( std::fwrite(OutputBuffer.Get<std::uint8_t>(), 1, OutputLength, Settings.OutputFile) != OutputLength )
+				{
+					std::fputs("Error writing to output file", stderr);
+					Result = EXIT_FAILURE;
+					return false;
+				}
+				CountBytes(Settings.Stats, &TranscodeStats::BytesOut, OutputLength);
+				return Continue;
+			}
+		);
+		if( std::ferror(Settings.InputFile) )
+		{
+			std::fputs("Error while reading input file",stderr);
+			return EXIT_FAILURE;
+		}
+		return Result;
+	}
+
+	// Regular files are memory-mapped, and their batches point into the
+	// mapping rather than into an input buffer
+	InputMapping Mapping;
+	const bool Mapped = MapInput(Settings.InputFile, Mapping);
+	const PageBuffer InputBuffers(Mapped ? 0 : InputSize * PipelineDepth);
+	const PageBuffer OutputBuffers(OutputSize * PipelineDepth);
+	if( (!Mapped && !InputBuffers) || !OutputBuffers )
+	{
+		if( Mapped ) munmap(Mapping.Base, Mapping.BaseSize);
+		std::fputs("Error allocating buffers", stderr);
+		return EXIT_FAILURE;
+	}
+
+	PipelineBatch Batches[PipelineDepth];
+	BatchQueue Free, Read, Transcoded;
+	for( std::size_t i = 0; i < PipelineDepth; ++i )
+	{
+		if( !Mapped )
+		{
+			Batches[i].Input = InputBuffers.Get<std::uint8_t>() + i * InputSize;
+		}
+		Batches[i].Output = OutputBuffers.Get<std::uint8_t>() + i * OutputSize;
+		Free.Push(i);
+	}
+	// Set upon an error in any stage, for the reader to stop reading
+	std::atomic<bool> Stop{false};
+	bool WriteFailed = false;
+
+	std::thread Reader(
+		[&]()
+		{
+			std::size_t Offset = 0;
+			std::size_t Index;
+			while( !Stop.load(std::memory_order_relaxed) && Free.Pop(Index) )
+			{
+				PipelineBatch& Batch = Batches[Index];
+				if( Mapped )
+				{
+					// Batches are written in order, so everything up to the end
+					// of a batch that has come back is no longer needed
+					ReleaseInput(Mapping, Batch.InputEnd, Settings.Stats);
+					if( Offset >= Mapping.Length ) break;
+					Batch.Input = Mapping.Data + Offset;
+					Batch.InputLength = std::min(InputSize, Mapping.Length - Offset);
+					ReadInput(Mapping, Offset, Batch.InputLength, Settings.Stats);
+				}
+				else
+				{
+					const PhaseTimer Timer(Settings.Stats, TranscodeStats::Read);
+					Batch.InputLength = std::fread(
+						const_cast<std::uint8_t*>(Batch.Input), 1, InputSize,
+						Settings.InputFile
+					);
+				}
+				if( Batch.InputLength == 0 ) break;
+				Offset += Batch.InputLength;
+				Batch.InputEnd = Offset;
+				Read.Push(Index);
+			}
+			Read.Close();
+		}
+	);
+	std::thread Writer(
+		[&]()
+		{
+			std::size_t Index;
+			while( Transcoded.Pop(Index) )
+			{
+				const PipelineBatch& Batch = Batches[Index];
+				if( !WriteFailed )
+				{
+					const PhaseTimer Timer(Settings.Stats, TranscodeStats::Write);
+					if(
+						std::fwrite(
+							Batch.Output, 1, Batch.OutputLength, Settings.OutputFile
+						) != Batch.OutputLength
+					)
+					{
+						WriteFailed = true;
+						Stop.store(true, std::memory_order_relaxed);
+					}
+					else
+					{
+						CountBytes(
+							Settings.Stats, &TranscodeStats::BytesOut,
+							Batch.OutputLength
+						);
+					}
+				}
+				Free.Push(Index);
+			}
+		}
+	);
+
+	bool Result = EXIT_SUCCESS;
+	std::size_t Index;
+	while( Read.Pop(Index) )
+	{
+		PipelineBatch& Batch = Batches[Index];
+		if( Result == EXIT_SUCCESS )
+		{
+			CountBytes(Settings.Stats, &TranscodeStats::BytesIn, Batch.InputLength);
+			const PhaseTimer Timer(Settings.Stats, TranscodeStats::Transcode);
+			if(
+				!Transcode(
+					Batch.Input, Batch.InputLength, Batch.Output,
+					Batch.OutputLength
+				)
+			)
+			{
+				Result = EXIT_FAILURE;
+				Stop.store(true, std::memory_order_relaxed);
+			}
+		}
+		else
+		{
+			// Drain what was read before the reader stopped
+			Batch.OutputLength = 0;
+		}
+		Transcoded.Push(Index);
+	}
+	Transcoded.Close();
+	Reader.join();
+	Writer.join();
+	if( Mapped )
+	{
+		munmap(Mapping.Base, Mapping.BaseSize);
+	}
+
+	if( WriteFailed )
+	{
+		std::fputs("Error writing to output file", stderr);
+		return EXIT_FAILURE;
+	}
+	if( std::ferror(Settings.InputFile) )
+	{
+		std::fputs("Error while reading input file",stderr);
+		return EXIT_FAILURE;
+	}
+	return Result;
+}
+
+#if defined(__linux__)
+// Hands `Length` bytes of page-aligned memory over to a pipe by reference.
+// The memory must not be modified until the reader has consumed it.
+bool SpliceWrite(
+	int OutputPipe, const void* Buffer, std::size_t Length, TranscodeStats* Stats
 )
 {
-	if( WrapWidth == 0 )
+	iovec Slice = { const_cast<void*>(Buffer), Length };
+	while( Slice.iov_len )
+	{
+		const ssize_t Spliced = vmsplice(OutputPipe, &Slice, 1, 0);
+		CountSyscall(Stats, TranscodeStats::Vmsplice);
+		if( Spliced < 0 )
+		{
+			if( errno == EINTR ) continue;
+			return false;
+		}
+		Slice.iov_base = static_cast<char*>(Slice.iov_base) + Spliced;
+		Slice.iov_len -= Spliced;
+	}
+	return true;
+}
+
+// When the output is a pipe, the encoded output is handed to the kernel with
+// `vmsplice` rather than copied into the pipe. Output is encoded into a ring
+// of page-aligned slices, and a slice is only reused after more than the
+// pipe's capacity has been spliced after it, by which point the reader has
+// consumed every page of it.
+bool EncodeSplice( const Settings& Settings, int OutputPipe, int PipeSize )
+{
+	const std::size_t ThreadCount = GetThreadCount(Settings);
+	const std::size_t InputSize = GetBatchSize(Settings);
+	// Room for the encoded bytes and their newlines, in whole pages
+	const std::size_t SliceSize = (
+		Base2::WrappedSize(InputSize, Settings.Wrap, Settings.Wrap)
+		+ PageSize - 1
+	) / PageSize * PageSize;
+	const std::size_t SliceCount = PipeSize / SliceSize + 2;
+
+	const PageBuffer InputBuffer(InputSize);
+	const PageBuffer SliceRing(SliceSize * SliceCount);
+	if( !InputBuffer || !SliceRing )
+	{
+		std::fputs("Error allocating buffers", stderr);
+		return EXIT_FAILURE;
+	}
+
+	bool Result = EXIT_SUCCESS;
+	std::size_t CurrentColumn = 0;
+	std::size_t CurSlice = 0;
+	ReadBatches(
+		Settings.InputFile, InputBuffer.Get<std::uint8_t>(), InputSize,
+		Settings.Stats,
+		[&](const std::uint8_t* Batch, std::size_t CurRead) -> bool
+		{
+			char* Slice = SliceRing.Get<char>() + CurSlice * SliceSize;
+			const std::size_t SliceLength = Base2::WrappedSize(
+				CurRead, Settings.Wrap, CurrentColumn
+			);
+			{
+				const PhaseTimer Timer(Settings.Stats, TranscodeStats::Transcode);
+				CurrentColumn = Base2::ParallelEncodeWrapped(
+					Batch, Slice, CurRead, Settings.Wrap, CurrentColumn, ThreadCount
+				);
+			}
+			CountBytes(Settings.Stats, &TranscodeStats::BytesIn, CurRead);
+			const PhaseTimer Timer(Settings.Stats, TranscodeStats::Write);
+			if( !SpliceWrite(OutputPipe, Slice, SliceLength, Settings.Stats) )
+			{
+				std::fputs("Error writing to output pipe", stderr);
+				Result = EXIT_FAILURE;
+				return false;
+			}
+			CountBytes(Settings.Stats, &TranscodeStats::BytesOut, SliceLength);
+			CurSlice = (CurSlice + 1) % SliceCount;
+			return true;
+		}
+	);
+	if( std::ferror(Settings.InputFile) )
 	{
-		return std::fwrite(Buffer, 1, Length, OutputFile);
+		std::fputs("Error while reading input file",stderr);
 	}
-	for( std::size_t Written = 0; Written < Length; )
+	return Result;
+}
+#endif
+
+#if defined(BASE2_HAVE_LIBURING)
+// Batches that are transcoded between completions, each with a read or a
+// write in flight while the others are being transcoded
+const static std::size_t UringSlotCount = 4;
+// Largest read or write submitted at once, the rest of it is resubmitted
+const static std::size_t UringMaxTransfer = std::size_t(1) << 30;
+
+// A batch of input and its output, at their positions within the files
+struct UringSlot
+{
+	std::uint8_t* Input        = nullptr;
+	std::uint8_t* Output       = nullptr;
+	// Positions relative to where the input and output files started at
+	std::size_t InputOffset    = 0;
+	std::size_t InputLength    = 0;
+	std::size_t OutputOffset   = 0;
+	std::size_t OutputLength   = 0;
+	// Bytes of the current read or write that have completed
+	std::size_t Transferred    = 0;
+	bool Writing               = false;
+	// Index of the input buffer within the registered buffers, the output
+	// buffer follows it
+	unsigned BufferIndex       = 0;
+};
+
+// Queues the rest of the slot's read or write at its position in the file
+void UringSubmit(
+	io_uring& Ring, UringSlot& Slot, bool Registered, int InputFD, int OutputFD,
+	off_t InputBase, off_t OutputBase
+)
+{
+	io_uring_sqe* Entry = io_uring_get_sqe(&Ring);
+	if( Slot.Writing )
+	{
+		const std::size_t Length = std::min(
+			Slot.OutputLength - Slot.Transferred, UringMaxTransfer
+		);
+		const off_t Offset = OutputBase + Slot.OutputOffset + Slot.Transferred;
+		std::uint8_t* Buffer = Slot.Output + Slot.Transferred;
+		if( Registered )
+		{
+			io_uring_prep_write_fixed(
+				Entry, OutputFD, Buffer, Length, Offset, Slot.BufferIndex + 1
+			);
+		}
+		else
+		{
+			io_uring_prep_write(Entry, OutputFD, Buffer, Length, Offset);
+		}
+	}
+	else
+	{
+		const std::size_t Length = std::min(
+			Slot.InputLength - Slot.Transferred, UringMaxTransfer
+		);
+		const off_t Offset = InputBase + Slot.InputOffset + Slot.Transferred;
+		std::uint8_t* Buffer = Slot.Input + Slot.Transferred;
+		if( Registered )
+		{
+			io_uring_prep_read_fixed(
+				Entry, InputFD, Buffer, Length, Offset, Slot.BufferIndex
+			);
+		}
+		else
+		{
+			io_uring_prep_read(Entry, InputFD, Buffer, Length, Offset);
+		}
+	}
+	io_uring_sqe_set_data(Entry, &Slot);
+}
+
+// When both the input and output are regular files, batches are read and
+// written at their positions within the files with io_uring, so that the
+// reads of upcoming batches and the writes of finished ones are in flight
+// while a batch is being transcoded. `Transcode(Slot)` transcodes the
+// slot's input into its output and sets the output's offset and length.
+// Returns false, before having read anything, when the files or the system
+// do not support this, and otherwise sets `Result`.
+template<typename TranscodeT>
+bool UringTranscode(
+	const Settings& Settings, std::size_t InputSize, std::size_t OutputSize,
+	TranscodeT&& Transcode, bool& Result
+)
+{
+	// A ring per file would cost more than it overlaps when there are other
+	// files being transcoded upon the other threads
+	if( Settings.Buffers )
+	{
+		return false;
+	}
+	const int InputFD = fileno(Settings.InputFile);
+	const int OutputFD = fileno(Settings.OutputFile);
+	struct stat InputStat, OutputStat;
+	if(
+		fstat(InputFD, &InputStat) != 0 || !S_ISREG(InputStat.st_mode)
+		|| fstat(OutputFD, &OutputStat) != 0 || !S_ISREG(OutputStat.st_mode)
+		|| (fcntl(OutputFD, F_GETFL) & O_APPEND)
+	)
+	{
+		return false;
+	}
+	std::fflush(Settings.OutputFile);
+	const off_t InputBase = lseek(InputFD, 0, SEEK_CUR);
+	const off_t OutputBase = lseek(OutputFD, 0, SEEK_CUR);
+	if( InputBase < 0 || OutputBase < 0 || InputBase > InputStat.st_size )
+	{
+		return false;
+	}
+	const std::size_t Length = InputStat.st_size - InputBase;
+
+	io_uring Ring;
+	if( io_uring_queue_init(UringSlotCount * 2, &Ring, 0) != 0 )
+	{
+		return false;
+	}
+
+	// Both buffers of each slot, in whole pages
+	InputSize = (InputSize + PageSize - 1) / PageSize * PageSize;
+	OutputSize = (OutputSize + PageSize - 1) / PageSize * PageSize;
+	const PageBuffer Buffers((InputSize + OutputSize) * UringSlotCount);
+	if( !Buffers )
+	{
+		io_uring_queue_exit(&Ring);
+		std::fputs("Error allocating buffers", stderr);
+		Result = EXIT_FAILURE;
+		return true;
+	}
+	UringSlot Slots[UringSlotCount];
+	iovec BufferSpans[UringSlotCount * 2];
+	for( std::size_t i = 0; i < UringSlotCount; ++i )
+	{
+		Slots[i].Input = Buffers.Get<std::uint8_t>() + i * (InputSize + OutputSize);
+		Slots[i].Output = Slots[i].Input + InputSize;
+		Slots[i].BufferIndex = i * 2;
+		BufferSpans[i * 2 + 0] = { Slots[i].Input, InputSize };
+		BufferSpans[i * 2 + 1] = { Slots[i].Output, OutputSize };
+	}
+	// Registered buffers spare the kernel from mapping the pages of each
+	// transfer, but count against the locked memory limit. Without them the
+	// transfers are submitted with plain reads and writes.
+	const bool Registered = io_uring_register_buffers(
+		&Ring, BufferSpans, UringSlotCount * 2
+	) == 0;
+
+	Result = EXIT_SUCCESS;
+	std::size_t NextOffset = 0;
+	std::size_t OutputEnd = 0;
+	std::size_t InFlight = 0;
+	for( UringSlot& Slot : Slots )
+	{
+		if( NextOffset >= Length ) break;
+		Slot.InputOffset = NextOffset;
+		Slot.InputLength = std::min(InputSize, Length - NextOffset);
+		NextOffset += Slot.InputLength;
+		UringSubmit(
+			Ring, Slot, Registered, InputFD, OutputFD, InputBase, OutputBase
+		);
+		++InFlight;
+	}
+	while( InFlight )
+	{
+		io_uring_cqe* Completion;
+		int Status;
+		{
+			const PhaseTimer Timer(Settings.Stats, TranscodeStats::Wait);
+			io_uring_submit(&Ring);
+			CountSyscall(Settings.Stats, TranscodeStats::UringSubmit);
+			Status = io_uring_wait_cqe(&Ring, &Completion);
+		}
+		if( Status == -EINTR ) continue;
+		if( Status < 0 )
+		{
+			std::fputs("Error waiting for io_uring completion", stderr);
+			Result = EXIT_FAILURE;
+			break;
+		}
+		UringSlot& Slot = *static_cast<UringSlot*>(
+			io_uring_cqe_get_data(Completion)
+		);
+		const int Transferred = Completion->res;
+		io_uring_cqe_seen(&Ring, Completion);
+		--InFlight;
+
+		if( Transferred == -EINTR || Transferred == -EAGAIN )
+		{
+			// Interrupted before anything was transferred, try it again
+		}
+		else if( Transferred <= 0 )
+		{
+			// Reads only come up short at the end of the input file, which
+			// was measured beforehand and must not have been truncated since
+			std::fputs(
+				Slot.Writing ?
+					"Error writing to output file" :
+					"Error while reading input file",
+				stderr
+			);
+			Result = EXIT_FAILURE;
+			// Let the transfers still in flight finish before the buffers are
+			// released
+			NextOffset = Length;
+			continue;
+		}
+		else
+		{
+			Slot.Transferred += Transferred;
+		}
+
+		if( Result == EXIT_FAILURE ) continue;
+		if( !Slot.Writing && Slot.Transferred == Slot.InputLength )
+		{
+			// The batch has been read, transcode it while the other slots'
+			// transfers are in flight and then write it out
+			{
+				const PhaseTimer Timer(Settings.Stats, TranscodeStats::Transcode);
+				Transcode(Slot);
+			}
+			CountBytes(Settings.Stats, &TranscodeStats::BytesIn, Slot.InputLength);
+			OutputEnd = std::max(OutputEnd, Slot.OutputOffset + Slot.OutputLength);
+			Slot.Writing = true;
+			Slot.Transferred = 0;
+		}
+		if( Slot.Writing && Slot.Transferred == Slot.OutputLength )
+		{
+			// The batch has been written, read the next one into the slot
+			CountBytes(Settings.Stats, &TranscodeStats::BytesOut, Slot.OutputLength);
+			if( NextOffset >= Length ) continue;
+			Slot.InputOffset = NextOffset;
+			Slot.InputLength = std::min(InputSize, Length - NextOffset);
+			NextOffset += Slot.InputLength;
+			Slot.Writing = false;
+			Slot.Transferred = 0;
+		}
+		UringSubmit(
+			Ring, Slot, Registered, InputFD, OutputFD, InputBase, OutputBase
+		);
+		++InFlight;
+	}
+	io_uring_queue_exit(&Ring);
+
+	// Leave both files positioned after what has been transcoded, as the
+	// stdio path would have
+	lseek(InputFD, InputBase + Length, SEEK_SET);
+	lseek(OutputFD, OutputBase + OutputEnd, SEEK_SET);
+	return true;
+}
+#endif
+
+// Writes all `Length` bytes of `Buffer` at `Offset` within the file
+bool WriteAt(
+	int OutputFD, const std::uint8_t* Buffer, std::size_t Length, off_t Offset
+)
+{
+	while( Length )
+	{
+		const ssize_t Written = pwrite(OutputFD, Buffer, Length, Offset);
+		if( Written < 0 )
+		{
+			if( errno == EINTR ) continue;
+			return false;
+		}
+		Buffer += Written;
+		Length -= Written;
+		Offset += Written;
+	}
+	return true;
+}
+
+// When the output is a regular file and the input may be memory-mapped, the
+// size of the output is known before anything has been transcoded. The
+// output file is then allocated to its final size, and each batch is written
+// straight to its final position within it, with no writes to keep in order.
+// When more than one thread may run at once, the output file is mapped as
+// well, for the threads to transcode each batch into its place with no buffer
+// to copy out of. On a single core, faulting in the pages of the mapping
+// costs more than that copy, so each batch is transcoded into a buffer of
+// `MaxOutputSize` bytes and written with `pwrite`, as it also is when the
+// file may not be mapped. `OutputSize(Length)` is the number of bytes of
+// output for `Length` bytes of input, and
+// `Transcode(Batch, Offset, Length, Output)` transcodes the batch at `Offset`
+// within the input into `Output`. Returns false, before having written
+// anything, when the files do not support this, and otherwise sets `Result`.
+template<typename OutputSizeT, typename TranscodeT>
+bool MappedTranscode(
+	const Settings& Settings, std::size_t InputSize, std::size_t MaxOutputSize,
+	OutputSizeT&& OutputSize, TranscodeT&& Transcode, bool& Result
+)
+{
+	const int OutputFD = fileno(Settings.OutputFile);
+	struct stat OutputStat;
+	if(
+		fstat(OutputFD, &OutputStat) != 0 || !S_ISREG(OutputStat.st_mode)
+		|| (fcntl(OutputFD, F_GETFL) & O_APPEND)
+	)
+	{
+		return false;
+	}
+	std::fflush(Settings.OutputFile);
+	const off_t OutputBase = lseek(OutputFD, 0, SEEK_CUR);
+	if( OutputBase < 0 )
+	{
+		return false;
+	}
+	InputMapping Mapping;
+	if( !MapInput(Settings.InputFile, Mapping) )
+	{
+		return false;
+	}
+	const std::size_t Length = OutputSize(Mapping.Length);
+	// Blocks are allocated up front so that running out of space is reported
+	// here, rather than raised as a `SIGBUS` from within the mapping
+	const int Status = Length ? posix_fallocate(OutputFD, OutputBase, Length) : 0;
+	if( Status != 0 || Length == 0 )
+	{
+		munmap(Mapping.Base, Mapping.BaseSize);
+		if( Status == ENOSPC || Status == EFBIG )
+		{
+			std::fputs("Error allocating output file", stderr);
+			Result = EXIT_FAILURE;
+			return true;
+		}
+		return false;
+	}
+	const std::size_t PageOffset = OutputBase % PageSize;
+	void* OutputMapping = MAP_FAILED;
+	if(
+		std::min<std::size_t>(
+			GetThreadCount(Settings), std::thread::hardware_concurrency()
+		) > 1
+	)
+	{
+		// Needs the file to be open for reading as well
+		OutputMapping = mmap(
+			0, PageOffset + Length, PROT_READ | PROT_WRITE, MAP_SHARED, OutputFD,
+			OutputBase - PageOffset
+		);
+	}
+	const bool Mapped = OutputMapping != MAP_FAILED;
+	const PageBuffer OutputBuffer(Mapped ? 0 : MaxOutputSize);
+	if( !Mapped && !OutputBuffer )
+	{
+		munmap(Mapping.Base, Mapping.BaseSize);
+		std::fputs("Error allocating buffers", stderr);
+		Result = EXIT_FAILURE;
+		return true;
+	}
+	std::uint8_t* Output = Mapped ?
+		static_cast<std::uint8_t*>(OutputMapping) + PageOffset : nullptr;
+
+	Result = EXIT_SUCCESS;
+	for( std::size_t Offset = 0; Offset < Mapping.Length; Offset += InputSize )
+	{
+		const std::size_t BatchLength = std::min(InputSize, Mapping.Length - Offset);
+		const std::size_t OutputOffset = OutputSize(Offset);
+		const std::size_t OutputLength
+			= OutputSize(Offset + BatchLength) - OutputOffset;
+		ReadInput(Mapping, Offset, BatchLength, Settings.Stats);
+	#if defined(MADV_POPULATE_WRITE)
+		if( Mapped )
+		{
+			// Faulting in the pages of the batch all at once is cheaper than
+			// faulting them in one at a time from within the kernels
+			const PhaseTimer Timer(Settings.Stats, TranscodeStats::Write);
+			const std::size_t PageStart = (PageOffset + OutputOffset) / PageSize * PageSize;
+			madvise(
+				static_cast<std::uint8_t*>(OutputMapping) + PageStart,
+				PageOffset + OutputOffset + OutputLength - PageStart,
+				MADV_POPULATE_WRITE
+			);
+			CountSyscall(Settings.Stats, TranscodeStats::Madvise);
+		}
+	#endif
+		std::uint8_t* BatchOutput = Mapped ?
+			Output + OutputOffset : OutputBuffer.Get<std::uint8_t>();
+		{
+			const PhaseTimer Timer(Settings.Stats, TranscodeStats::Transcode);
+			Transcode(Mapping.Data + Offset, Offset, BatchLength, BatchOutput);
+		}
+		if( !Mapped )
+		{
+			const PhaseTimer Timer(Settings.Stats, TranscodeStats::Write);
+			if(
+				!WriteAt(
+					OutputFD, BatchOutput, OutputLength, OutputBase + OutputOffset
+				)
+			)
+			{
+				std::fputs("Error writing to output file", stderr);
+				Result = EXIT_FAILURE;
+				break;
+			}
+		}
+		CountBytes(Settings.Stats, &TranscodeStats::BytesIn, BatchLength);
+		CountBytes(Settings.Stats, &TranscodeStats::BytesOut, OutputLength);
+		ReleaseInput(Mapping, Offset + BatchLength, Settings.Stats);
+	}
+	if( Mapped )
+	{
+		munmap(OutputMapping, PageOffset + Length);
+	}
+	munmap(Mapping.Base, Mapping.BaseSize);
+
+	// Leave both files positioned after what has been transcoded, as the
+	// stdio path would have
+	lseek(fileno(Settings.InputFile), Mapping.Length, SEEK_CUR);
+	lseek(OutputFD, OutputBase + Length, SEEK_SET);
+	return true;
+}
+
+// Encodes into the layout of `Settings.Format`. The separators before each
+// batch, and so where its output starts, only depend on the number of bytes
+// before it.
+bool EncodeFormatted( const Settings& Settings )
+{
+	const Base2::Format& Format = Settings.Format;
+	// Laid out once and shared by every batch
+	const Base2::FormattedEncoder Encoder(Format);
+	const std::size_t ThreadCount = GetThreadCount(Settings);
+	const std::size_t InputSize = GetBatchSize(Settings);
+	// A batch that starts just before a group has a separator more than one
+	// that starts at the beginning of the stream
+	const std::size_t OutputSize = Base2::FormattedSize(InputSize, Format)
+		+ std::strlen(Format.Separator);
+	bool MappedResult;
+	if(
+		MappedTranscode(
+			Settings, InputSize, OutputSize,
+			[&](std::size_t Length)
+			{
+				return Base2::FormattedSize(Length, Format);
+			},
+			[&](
+				const std::uint8_t* Batch, std::size_t Offset, std::size_t Length,
+				std::uint8_t* Output
+			)
+			{
+				Encoder.ParallelEncode(
+					Batch, reinterpret_cast<char*>(Output), Length, Offset,
+					ThreadCount
+				);
+			},
+			MappedResult
+		)
+	)
+	{
+		return MappedResult;
+	}
+#if defined(BASE2_HAVE_LIBURING)
+	bool UringResult;
+	if(
+		UringTranscode(
+			Settings, InputSize, OutputSize,
+			[&](UringSlot& Slot)
+			{
+				Slot.OutputOffset = Base2::FormattedSize(Slot.InputOffset, Format);
+				Slot.OutputLength = Encoder.ParallelEncode(
+					Slot.Input, reinterpret_cast<char*>(Slot.Output),
+					Slot.InputLength, Slot.InputOffset, ThreadCount
+				);
+			},
+			UringResult
+		)
+	)
+	{
+		return UringResult;
+	}
+#endif
+	std::uint64_t Position = 0;
+	return TranscodeBatches(
+		Settings, InputSize, OutputSize,
+		[&](
+			const std::uint8_t* Batch, std::size_t CurRead,
+			std::uint8_t* Output, std::size_t& OutputLength
+		) -> bool
+		{
+			OutputLength = Encoder.ParallelEncode(
+				Batch, reinterpret_cast<char*>(Output), CurRead, Position,
+				ThreadCount
+			);
+			Position += CurRead;
+			return true;
+		}
+	);
+}
+
+bool Encode( const Settings& Settings )
+{
+	if( Settings.Formatted )
+	{
+		return EncodeFormatted(Settings);
+	}
+#if defined(__linux__)
+	const int OutputFD = fileno(Settings.OutputFile);
+	struct stat OutputStat;
+	if( fstat(OutputFD, &OutputStat) == 0 && S_ISFIFO(OutputStat.st_mode) )
+	{
+		// Grow the pipe so that more pages may be in flight at once. This may
+		// fail for unprivileged users beyond `/proc/sys/fs/pipe-max-size`, in
+		// which case the current capacity is used.
+		fcntl(OutputFD, F_SETPIPE_SZ, PipeBuffSize);
+		const int PipeSize = fcntl(OutputFD, F_GETPIPE_SZ);
+		if( PipeSize > 0 )
+		{
+			return EncodeSplice(Settings, OutputFD, PipeSize);
+		}
+	}
+#endif
+
+	const std::size_t ThreadCount = GetThreadCount(Settings);
+	const std::size_t InputSize = GetBatchSize(Settings);
+	// Each byte of input will map to 8 bytes of output, plus newlines
+	const std::size_t OutputSize = Base2::WrappedSize(
+		InputSize, Settings.Wrap, Settings.Wrap
+	);
+	bool MappedResult;
+	if(
+		MappedTranscode(
+			Settings, InputSize, OutputSize,
+			[&](std::size_t Length)
+			{
+				return Base2::WrappedSize(Length, Settings.Wrap);
+			},
+			[&](
+				const std::uint8_t* Batch, std::size_t Offset, std::size_t Length,
+				std::uint8_t* Output
+			)
+			{
+				Base2::ParallelEncodeWrapped(
+					Batch, reinterpret_cast<char*>(Output), Length, Settings.Wrap,
+					Base2::WrappedColumn(Offset, Settings.Wrap), ThreadCount
+				);
+			},
+			MappedResult
+		)
+	)
+	{
+		return MappedResult;
+	}
+#if defined(BASE2_HAVE_LIBURING)
+	bool UringResult;
+	if(
+		UringTranscode(
+			Settings, InputSize, OutputSize,
+			[&](UringSlot& Slot)
+			{
+				// The position and column of each batch follow from the
+				// number of bytes before it
+				const std::size_t Column = Base2::WrappedColumn(
+					Slot.InputOffset, Settings.Wrap
+				);
+				Slot.OutputOffset = Base2::WrappedSize(
+					Slot.InputOffset, Settings.Wrap
+				);
+				Slot.OutputLength = Base2::WrappedSize(
+					Slot.InputLength, Settings.Wrap, Column
+				);
+				Base2::ParallelEncodeWrapped(
+					Slot.Input, reinterpret_cast<char*>(Slot.Output),
+					Slot.InputLength, Settings.Wrap, Column, ThreadCount
+				);
+			},
+			UringResult
+		)
+	)
+	{
+		return UringResult;
+	}
+#endif
+	std::size_t CurrentColumn = 0;
+	return TranscodeBatches(
+		Settings, InputSize, OutputSize,
+		[&](
+			const std::uint8_t* Batch, std::size_t CurRead,
+			std::uint8_t* Output, std::size_t& OutputLength
+		) -> bool
+		{
+			// Chunks are encoded in parallel, with their newlines, into their
+			// final position within the output buffer. The column that each
+			// chunk and batch starts at follows from the digits before it.
+			OutputLength = Base2::WrappedSize(
+				CurRead, Settings.Wrap, CurrentColumn
+			);
+			CurrentColumn = Base2::ParallelEncodeWrapped(
+				Batch, reinterpret_cast<char*>(Output), CurRead, Settings.Wrap,
+				CurrentColumn, ThreadCount
+			);
+			return true;
+		}
+	);
+}
+
+// Line width of wrapped ascii-binary, taken from its first line. Returns `0`
+// when the first line is not a line of digits.
+std::size_t DetectWrap( const std::uint8_t* Input, std::size_t Length )
+{
+	const void* LineEnd = std::memchr(Input, '\n', Length);
+	if( LineEnd == nullptr )
+	{
+		return 0;
+	}
+	std::size_t Width = static_cast<const std::uint8_t*>(LineEnd) - Input;
+	if( Width && Input[Width - 1] == '\r' )
+	{
+		--Width;
+	}
+	for( std::size_t i = 0; i < Width; ++i )
+	{
+		if( (Input[i] & 0xFE) != 0x30 )
+		{
+			return 0;
+		}
+	}
+	return Width;
+}
+
+// Decodes only the bytes of `--offset` and `--length`. The input is
+// memory-mapped and the digits of the range are located within it by
+// `Base2::RangeDecoder`, so only the pages of the range are read from the
+// file rather than everything before them.
+bool DecodeRange( const Settings& Settings )
+{
+	struct stat InputStat;
+	if(
+		fstat(fileno(Settings.InputFile), &InputStat) != 0
+		|| !S_ISREG(InputStat.st_mode)
+	)
+	{
+		std::fputs("--offset and --length need a regular input file", stderr);
+		return EXIT_FAILURE;
+	}
+	InputMapping Mapping;
+	if( !MapInput(Settings.InputFile, Mapping) )
+	{
+		// Nothing past the current position of the file
+		return EXIT_SUCCESS;
+	}
+	// Any part of the input may be read first, reading ahead of it
+	// sequentially is left to the kernel's default
+	madvise(Mapping.Base, Mapping.BaseSize, MADV_NORMAL);
+
+	const std::size_t OutputSize = GetBatchSize(Settings);
+	const PageBuffer OutputBuffer(OutputSize);
+	if( !OutputBuffer )
+	{
+		munmap(Mapping.Base, Mapping.BaseSize);
+		std::fputs("Error allocating buffers", stderr);
+		return EXIT_FAILURE;
+	}
+	Base2::RangeDecoder Decoder(Mapping.Data, Mapping.Length);
+	bool Result = EXIT_SUCCESS;
+	std::uint64_t Offset = Settings.RangeOffset;
+	std::uint64_t Remaining = Settings.RangeLength;
+	while( Remaining )
+	{
+		const std::size_t Length = std::min<std::uint64_t>(OutputSize, Remaining);
+		std::size_t Written;
+		{
+			const PhaseTimer Timer(Settings.Stats, TranscodeStats::Transcode);
+			Written = Decoder.Decode(
+				Offset, Length, OutputBuffer.Get<std::uint8_t>()
+			);
+		}
+		CountBytes(Settings.Stats, &TranscodeStats::BytesIn, Written * 8);
+		{
+			const PhaseTimer Timer(Settings.Stats, TranscodeStats::Write);
+			if( std::fwrite(OutputBuffer.Get<std::uint8_t>(), 1, Written, Settings.OutputFile) != Written )
+			{
+				std::fputs("Error writing to output file", stderr);
+				Result = EXIT_FAILURE;
+				break;
+			}
+		}
+		CountBytes(Settings.Stats, &TranscodeStats::BytesOut, Written);
+		// The input ended before the range did
+		if( Written < Length ) break;
+		Offset += Written;
+		Remaining -= Written;
+	}
+	munmap(Mapping.Base, Mapping.BaseSize);
+	return Result;
+}
+
+// Decodes ascii-binary in the layout of `Settings.Format`, skipping the texts
+// of the format along with any other byte that is not a digit
+bool DecodeFormatted( const Settings& Settings )
+{
+	const std::size_t OutputSize = GetBatchSize(Settings);
+	const std::size_t InputSize = OutputSize * 8;
+	Base2::FormattedDecoder Decoder(Settings.Format);
+	// Room for the digits that are carried and held back from the batch before
+	const std::size_t MaxOutputSize = OutputSize + Base2::MaxFormatText;
+	const bool Result = TranscodeBatches(
+		Settings, InputSize, MaxOutputSize,
+		[&](
+			const std::uint8_t* Batch, std::size_t CurRead,
+			std::uint8_t* Output, std::size_t& OutputLength
+		) -> bool
+		{
+			OutputLength = Decoder.Update(Batch, CurRead, Output);
+			return true;
+		}
+	);
+	if( Result != EXIT_SUCCESS )
+	{
+		return Result;
+	}
+	// The end of the input that was held back in case it started a text
+	std::uint8_t Rest[Base2::MaxFormatText];
+	const std::size_t RestLength = Decoder.Finish(Rest);
+	if( std::fwrite(Rest, 1, RestLength, Settings.OutputFile) != RestLength )
+	{
+		std::fputs("Error writing to output file", stderr);
+		return EXIT_FAILURE;
+	}
+	CountBytes(Settings.Stats, &TranscodeStats::BytesOut, RestLength);
+	return EXIT_SUCCESS;
+}
+
+// By default, Decode will extract the lowest set bit in a chunk of 8 bytes
+// and compress it down into 1 byte.
+// Even if the input is not '0'(0x30) or '1'(0x31) it will do this unless
+// the settings explicitly say to ignore non-'0''1' garbage bytes.
+bool Decode( const Settings& Settings )
+{
+	if( Settings.DecodeRange )
+	{
+		return DecodeRange(Settings);
+	}
+	if( Settings.Formatted )
+	{
+		return DecodeFormatted(Settings);
+	}
+	const std::size_t ThreadCount = GetThreadCount(Settings);
+	const std::size_t OutputSize = GetBatchSize(Settings);
+	const std::size_t InputSize = OutputSize * 8;
+	bool MappedResult;
+	if(
+		!Settings.Strict && !Settings.IgnoreInvalid
+		&& MappedTranscode(
+			Settings, InputSize, OutputSize,
+			[](std::size_t Length)
+			{
+				// Any incomplete group at the end of the input is discarded
+				return Length / 8;
+			},
+			[&](
+				const std::uint8_t* Batch, std::size_t, std::size_t Length,
+				std::uint8_t* Output
+			)
+			{
+				Base2::ParallelDecode(
+					reinterpret_cast<const std::uint64_t*>(Batch), Output, Length / 8,
+					ThreadCount
+				);
+			},
+			MappedResult
+		)
+	)
+	{
+		return MappedResult;
+	}
+#if defined(BASE2_HAVE_LIBURING)
+	bool UringResult;
+	if(
+		!Settings.Strict && !Settings.IgnoreInvalid
+		&& UringTranscode(
+			Settings, InputSize, OutputSize,
+			[&](UringSlot& Slot)
+			{
+				// Every batch but the last is a multiple of 8 bytes
+				Slot.OutputOffset = Slot.InputOffset / 8;
+				Slot.OutputLength = Slot.InputLength / 8;
+				Base2::ParallelDecode(
+					reinterpret_cast<const std::uint64_t*>(Slot.Input),
+					Slot.Output, Slot.OutputLength, ThreadCount
+				);
+			},
+			UringResult
+		)
+	)
+	{
+		return UringResult;
+	}
+#endif
+	if( Settings.Strict )
+	{
+		// Every byte must be a digit, aside from a line ending after the last
+		// complete group of 8. Input that is wrapped, as told by its first
+		// line, may also have a line ending after every line of that width.
+		std::size_t BatchOffset = 0;
+		std::unique_ptr<Base2::CheckedWrapDecoder> Wrapped;
+		bool FirstBatch = true;
+		const bool Result = TranscodeBatches(
+			Settings, InputSize, OutputSize,
+			[&](
+				const std::uint8_t* Batch, std::size_t CurRead,
+				std::uint8_t* Output, std::size_t& OutputLength
+			) -> bool
+			{
+				if( FirstBatch )
+				{
+					const std::size_t Wrap = DetectWrap(Batch, CurRead);
+					if( Wrap )
+					{
+						Wrapped = std::make_unique<Base2::CheckedWrapDecoder>(
+							Wrap, ThreadCount
+						);
+					}
+					FirstBatch = false;
+				}
+				if( Wrapped )
+				{
+					OutputLength = Wrapped->Update(Batch, CurRead, Output);
+					if( Wrapped->Failed() )
+					{
+						std::fprintf(
+							stderr, "Invalid byte 0x%02X at offset %" PRIu64 "\n",
+							Wrapped->FailedByte(), Wrapped->FailedOffset()
+						);
+						return false;
+					}
+					return true;
+				}
+				const std::size_t Groups = CurRead / 8;
+				std::size_t Invalid = Base2::ParallelDecodeChecked(
+					reinterpret_cast<const std::uint64_t*>(Batch), Output, Groups,
+					ThreadCount
+				);
+				OutputLength = Invalid / 8;
+				if( Invalid == Groups * 8 )
+				{
+					std::size_t Rest = CurRead - Invalid;
+					if( Rest && Batch[Invalid + Rest - 1] == '\n' ) --Rest;
+					if( Rest && Batch[Invalid + Rest - 1] == '\r' ) --Rest;
+					if( Rest == 0 )
+					{
+						BatchOffset += CurRead;
+						return true;
+					}
+					while( Rest && (Batch[Invalid] & 0xFE) == 0x30 )
+					{
+						++Invalid;
+						--Rest;
+					}
+					if( Rest == 0 )
+					{
+						std::fprintf(
+							stderr, "Incomplete group of %zu digits at end of input\n",
+							Invalid - Groups * 8
+						);
+						return false;
+					}
+				}
+				std::fprintf(
+					stderr, "Invalid byte 0x%02X at offset %zu\n",
+					Batch[Invalid], BatchOffset + Invalid
+				);
+				return false;
+			}
+		);
+		if( Result != EXIT_SUCCESS || !Wrapped )
+		{
+			return Result;
+		}
+		const std::size_t Incomplete = Wrapped->Finish();
+		if( Wrapped->Failed() )
+		{
+			std::fprintf(
+				stderr, "Invalid byte 0x%02X at offset %" PRIu64 "\n",
+				Wrapped->FailedByte(), Wrapped->FailedOffset()
+			);
+			return EXIT_FAILURE;
+		}
+		if( Incomplete )
+		{
+			std::fprintf(
+				stderr, "Incomplete group of %zu digits at end of input\n",
+				Incomplete
+			);
+			return EXIT_FAILURE;
+		}
+		return EXIT_SUCCESS;
+	}
+
+	if( !Settings.IgnoreInvalid )
+	{
+		// Every batch but the last is a multiple of 8 bytes, so only the end of
+		// the input can have an incomplete group, which is discarded
+		return TranscodeBatches(
+			Settings, InputSize, OutputSize,
+			[&](
+				const std::uint8_t* Batch, std::size_t CurRead,
+				std::uint8_t* Output, std::size_t& OutputLength
+			) -> bool
+			{
+				// Process any new groups of 8 ascii-bytes
+				OutputLength = CurRead / 8;
+				Base2::ParallelDecode(
+					reinterpret_cast<const std::uint64_t*>(Batch), Output,
+					OutputLength, ThreadCount
+				);
+				return true;
+			}
+		);
+	}
+
+	if( ThreadCount == 1 )
+	{
+		// Filter and decode each batch in a single pass, carrying any
+		// incomplete group over to the next batch. Line endings are skipped
+		// in bulk when the lines are as wide as the first one.
+		Base2::StreamDecoder Decoder;
+		bool FirstBatch = true;
+		std::uint64_t Consumed = 0;
+		std::uint64_t Decoded = 0;
+		const bool Result = TranscodeBatches(
+			Settings, InputSize, OutputSize,
+			[&](
+				const std::uint8_t* Batch, std::size_t CurRead,
+				std::uint8_t* Output, std::size_t& OutputLength
+			) -> bool
+			{
+				if( FirstBatch )
+				{
+					Decoder = Base2::StreamDecoder(DetectWrap(Batch, CurRead));
+					FirstBatch = false;
+				}
+				OutputLength = Decoder.Update(Batch, CurRead, Output);
+				Consumed += CurRead;
+				Decoded += OutputLength;
+				return true;
+			}
+		);
+		// Every byte that was not decoded, nor left over as an incomplete
+		// group, was garbage
+		CountBytes(
+			Settings.Stats, &TranscodeStats::Garbage,
+			Consumed - Decoded * 8 - Decoder.Finish()
+		);
+		return Result;
+	}
+
+	// Every 8 bytes of input will map to 1 byte of output
+	const PageBuffer InputBuffer(InputSize);
+	const PageBuffer OutputBuffer(OutputSize);
+	if( !InputBuffer || !OutputBuffer )
+	{
+		std::fputs("Error allocating buffers", stderr);
+		return EXIT_FAILURE;
+	}
+	std::uint8_t* InputBytes = InputBuffer.Get<std::uint8_t>();
+
+	// Ascii-bytes of an incomplete group of 8, carried over to the front of
+	// the input buffer for the next read
+	std::size_t Leftover = 0;
+	// Process large batches of input in an attempt to have bulk-amounts of
+	// conversions going on between calls to `read`
+	for( ;; )
 	{
-		const std::size_t ColumnsRemaining = WrapWidth - CurrentColumn;
-		const std::size_t ToWrite = std::min(
-			ColumnsRemaining, Length - Written
-		);
-		if( ToWrite == 0)
+		// Number of bytes available for actual processing
+		std::size_t CurRead = 0;
 		{
-			std::fputc('\n',OutputFile);
-			CurrentColumn = 0;
+			const PhaseTimer Timer(Settings.Stats, TranscodeStats::Read);
+			CurRead = std::fread(
+				InputBytes + Leftover, 1, InputSize - Leftover, Settings.InputFile
+			);
 		}
-		else
+		if( CurRead == 0 ) break;
+		// Filter input of all garbage bytes and decode it, leaving any
+		// incomplete group at the front of the input buffer
+		std::size_t Available;
+		{
+			const PhaseTimer Timer(Settings.Stats, TranscodeStats::Transcode);
+			Available = Base2::ParallelFilterDecode(
+				InputBytes, OutputBuffer.Get<std::uint8_t>(), Leftover + CurRead,
+				ThreadCount
+			);
+		}
+		CountBytes(Settings.Stats, &TranscodeStats::BytesIn, CurRead);
+		CountBytes(
+			Settings.Stats, &TranscodeStats::Garbage,
+			CurRead - (Available - Leftover)
+		);
 		{
-			std::fwrite(Buffer + Written, 1, ToWrite, OutputFile);
-			CurrentColumn += ToWrite;
-			Written += ToWrite;
+			const PhaseTimer Timer(Settings.Stats, TranscodeStats::Write);
+			if( std::fwrite(OutputBuffer.Get<std::uint8_t>(), 1, Available / 8, Settings.OutputFile) != Available / 8 )
+			{
+				std::fputs("Error writing to output file", stderr);
+				return EXIT_FAILURE;
+			}
 		}
+		CountBytes(Settings.Stats, &TranscodeStats::BytesOut, Available / 8);
+
+		// Set up for next read
+		Leftover = Available % 8;
+	}
+	if( std::ferror(Settings.InputFile) )
+	{
+		std::fputs("Error while reading input file",stderr);
+		return EXIT_FAILURE;
 	}
-	return CurrentColumn;
+	return EXIT_SUCCESS;
 }
 
-bool Encode( const Settings& Settings )
+// Transcodes the file at `InputPath` into the file at `OutputPath`, naming
+// the input file along with any error
+bool TranscodeFile(
+	Settings& Settings, const char* InputPath, const char* OutputPath
+)
 {
-	// Each byte of input will map to 8 bytes of output
-	std::uint8_t* InputBuffer = static_cast<std::uint8_t*>(
-		mmap(
-			0, ByteBuffSize,
-			PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0
-		)
-	);
-	std::uint64_t* OutputBuffer = static_cast<std::uint64_t*>(
-		mmap(
-			0, AsciiBuffSize,
-			PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0
-		)
-	);
-	std::size_t CurrentColumn = 0;
-	std::size_t CurRead = 0;
-	while( (CurRead = std::fread(InputBuffer, 1, ByteBuffSize, Settings.InputFile)) )
+	std::FILE* InputFile = std::fopen(InputPath, "rb");
+	if( InputFile == nullptr )
 	{
-		Base2::Encode(InputBuffer, OutputBuffer, CurRead);
-		CurrentColumn = WrapWrite(
-			reinterpret_cast<const char*>(OutputBuffer), CurRead * 8,
-			Settings.Wrap, Settings.OutputFile, CurrentColumn
-		);
+		std::fprintf(stderr, "Error opening input file: %s\n", InputPath);
+		return EXIT_FAILURE;
 	}
-	if( std::ferror(Settings.InputFile) )
+	// Opening the output file truncates it, which must not happen to the input
+	struct stat InputStat, OutputStat;
+	if(
+		fstat(fileno(InputFile), &InputStat) == 0
+		&& stat(OutputPath, &OutputStat) == 0
+		&& InputStat.st_dev == OutputStat.st_dev
+		&& InputStat.st_ino == OutputStat.st_ino
+	)
 	{
-		std::fputs("Error while reading input file",stderr);
+		std::fprintf(stderr, "Output file is the input file: %s\n", InputPath);
+		std::fclose(InputFile);
+		return EXIT_FAILURE;
 	}
-	munmap(InputBuffer,  ByteBuffSize);
-	munmap(OutputBuffer, AsciiBuffSize);
-	return EXIT_SUCCESS;
+	// Opened for reading as well, without which the file cannot be mapped
+	std::FILE* OutputFile = std::fopen(OutputPath, "w+b");
+	if( OutputFile == nullptr )
+	{
+		std::fprintf(stderr, "Error opening output file: %s\n", OutputPath);
+		std::fclose(InputFile);
+		return EXIT_FAILURE;
+	}
+
+	Settings.InputFile = InputFile;
+	Settings.OutputFile = OutputFile;
+	bool Result = (Settings.Decode ? Decode : Encode)(Settings);
+	if( std::fclose(OutputFile) != 0 && Result == EXIT_SUCCESS )
+	{
+		std::fprintf(stderr, "Error writing to output file: %s\n", OutputPath);
+		Result = EXIT_FAILURE;
+	}
+	else if( Result != EXIT_SUCCESS )
+	{
+		std::fprintf(stderr, "\nError transcoding file: %s\n", InputPath);
+	}
+	std::fclose(InputFile);
+	return Result;
 }
 
-// By default, Decode will extract the lowest set bit in a chunk of 8 bytes
-// and compress it down into 1 byte.
-// Even if the input is not '0'(0x30) or '1'(0x31) it will do this unless
-// the settings explicitly say to ignore non-'0''1' garbage bytes.
-bool Decode( const Settings& Settings )
+// Transcodes each file of `InputPaths` into a file of the same name within
+// `OutputDir`, all within this one process. The files are handed out to as
+// many threads as the settings ask for, each of which transcodes one file at
+// a time with buffers that it reuses from one file to the next.
+bool TranscodeFiles(
+	const Settings& Settings, const char* OutputDir,
+	const std::vector<std::string>& InputPaths
+)
 {
-	// Every 8 bytes of input will map to 1 byte of output
-	std::uint64_t* InputBuffer = static_cast<std::uint64_t*>(
-		mmap(
-			0, AsciiBuffSize,
-			PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0
-		)
+	std::vector<std::string> OutputPaths(InputPaths.size());
+	for( std::size_t i = 0; i < InputPaths.size(); ++i )
+	{
+		const char* Name = std::strrchr(InputPaths[i].c_str(), '/');
+		Name = Name ? Name + 1 : InputPaths[i].c_str();
+		if( *Name == '\0' || std::strcmp(Name, "-") == 0 )
+		{
+			std::fprintf(
+				stderr, "Input file has no name to output to: %s\n",
+				InputPaths[i].c_str()
+			);
+			return EXIT_FAILURE;
+		}
+		OutputPaths[i] = std::string(OutputDir) + '/' + Name;
+	}
+	// Input files of the same name from different directories would be
+	// written over one another
+	std::vector<std::string> SortedPaths(OutputPaths);
+	std::sort(SortedPaths.begin(), SortedPaths.end());
+	const auto Duplicate = std::adjacent_find(
+		SortedPaths.begin(), SortedPaths.end()
 	);
-	std::uint8_t* OutputBuffer = static_cast<std::uint8_t*>(
-		mmap(
-			0, ByteBuffSize,
-			PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0
-		)
+	if( Duplicate != SortedPaths.end() )
+	{
+		std::fprintf(
+			stderr, "Input files share an output file: %s\n", Duplicate->c_str()
+		);
+		return EXIT_FAILURE;
+	}
+
+	std::atomic<std::size_t> NextFile{0};
+	std::atomic<bool> Failed{false};
+	const auto Worker = [&]()
+	{
+		BatchBuffers Buffers;
+		struct Settings FileSettings = Settings;
+		FileSettings.Threads = 1;
+		FileSettings.Buffers = &Buffers;
+		for( ;; )
+		{
+			const std::size_t i = NextFile.fetch_add(1, std::memory_order_relaxed);
+			if( i >= InputPaths.size() ) break;
+			if(
+				TranscodeFile(
+					FileSettings, InputPaths[i].c_str(), OutputPaths[i].c_str()
+				) != EXIT_SUCCESS
+			)
+			{
+				Failed.store(true, std::memory_order_relaxed);
+			}
+		}
+	};
+	const std::size_t WorkerCount = std::min(
+		GetThreadCount(Settings), InputPaths.size()
 	);
+	std::vector<std::thread> Workers;
+	for( std::size_t i = 1; i < WorkerCount; ++i )
+	{
+		Workers.emplace_back(Worker);
+	}
+	Worker();
+	for( std::thread& CurWorker : Workers )
+	{
+		CurWorker.join();
+	}
+	return Failed.load() ? EXIT_FAILURE : EXIT_SUCCESS;
+}
 
-	std::size_t ToRead = AsciiBuffSize;
-	// Number of bytes available for actual processing
-	std::size_t CurRead = 0;
-	// Process paged-sized batches of input in an attempt to have bulk-amounts of
-	// conversions going on between calls to `read`
-	while(
-		(CurRead = std::fread(
-			reinterpret_cast<std::uint8_t*>(InputBuffer) + (AsciiBuffSize - ToRead),
-			1, ToRead, Settings.InputFile
-		))
-	)
+// Appends the paths listed within `ListFile`, one per line
+void ReadFileList( std::FILE* ListFile, std::vector<std::string>& Paths )
+{
+	char* Line = nullptr;
+	std::size_t LineSize = 0;
+	ssize_t Length;
+	while( (Length = getline(&Line, &LineSize, ListFile)) >= 0 )
 	{
-		// Filter input of all garbage bytes
-		if( Settings.IgnoreInvalid )
+		while( Length && (Line[Length - 1] == '\n' || Line[Length - 1] == '\r') )
 		{
-			CurRead = Base2::Filter(
-				reinterpret_cast<std::uint8_t*>(InputBuffer) + (AsciiBuffSize - ToRead),
-				CurRead
-			);
+			--Length;
 		}
-		// Process any new groups of 8 ascii-bytes
-		Base2::Decode(
-			InputBuffer + (AsciiBuffSize - ToRead) / 8,
-			OutputBuffer, CurRead / 8
-		);
-		if( std::fwrite(OutputBuffer, 1, CurRead / 8, Settings.OutputFile) != CurRead / 8 )
+		if( Length )
 		{
-			std::fputs("Error writing to output file", stderr);
-			munmap(InputBuffer, AsciiBuffSize);
-			munmap(OutputBuffer, ByteBuffSize);
-			return EXIT_FAILURE;
+			Paths.emplace_back(Line, Length);
 		}
+	}
+	std::free(Line);
+}
 
-		// Set up for next read
-		ToRead -= CurRead; 
-		if( ToRead == 0 )
+// Parses a number of bytes with an optional `K`, `M`, or `G` suffix. Returns
+// false if it is not one.
+bool ParseSize( const char* Argument, std::uint64_t& Size )
+{
+	char* Suffix = nullptr;
+	errno = 0;
+	Size = std::strtoull(Argument, &Suffix, 10);
+	if( Suffix == Argument || *Argument == '-' || errno == ERANGE )
+	{
+		return false;
+	}
+	std::size_t Scale = 0;
+	switch( *Suffix )
+	{
+	case 'G': case 'g': ++Scale;
+	[[fallthrough]];
+	case 'M': case 'm': ++Scale;
+	[[fallthrough]];
+	case 'K': case 'k': ++Scale; ++Suffix;
+	}
+	for( ; Scale; --Scale )
+	{
+		// A size that does not fit is rejected rather than wrapped around
+		if( Size > UINT64_MAX / 1024 )
 		{
-			ToRead = AsciiBuffSize;
+			return false;
 		}
+		Size *= 1024;
 	}
-	munmap(InputBuffer, AsciiBuffSize);
-	munmap(OutputBuffer, ByteBuffSize);
-	if( std::ferror(Settings.InputFile) )
+	return *Suffix == '\0';
+}
+
+// Parses a text of a format, with `\n`, `\r`, `\t`, and `\\` escapes. Returns
+// false upon any other escape.
+bool ParseText( const char* Argument, std::string& Text )
+{
+	Text.clear();
+	for( ; *Argument; ++Argument )
 	{
-		std::fputs("Error while reading input file",stderr);
-		return EXIT_FAILURE;
+		if( *Argument != '\\' )
+		{
+			Text += *Argument;
+			continue;
+		}
+		switch( *++Argument )
+		{
+		case 'n':  Text += '\n'; break;
+		case 'r':  Text += '\r'; break;
+		case 't':  Text += '\t'; break;
+		case '\\': Text += '\\'; break;
+		default: return false;
+		}
 	}
-	return EXIT_SUCCESS;
+	return true;
 }
 
 const char* Usage = 
 "base2 - Wunkolo <wunkolo@gmail.com>\n"
 "Usage: base2 [Options]... [File]\n"
 "       base2 --decode [Options]... [File]\n"
+"       base2 [--decode] [Options]... --output=Dir [File]...\n"
 "Options:\n"
 "  -h, --help            Display this help/usage information\n"
 "  -d, --decode          Decodes incoming binary ascii into bytes\n"
 "  -i, --ignore-garbage  When decoding, ignores non-ascii-binary `0`, `1` bytes\n"
+"  -s, --strict          When decoding, fails upon any non-ascii-binary byte\n"
+"                        and reports its offset. Line endings are only\n"
+"                        allowed after every line as wide as the first\n"
+"      --offset=Bytes    When decoding, start at this byte of the decoded\n"
+"                        output, locating its digits within the input file\n"
+"                        rather than decoding everything before it\n"
+"      --length=Bytes    When decoding, decode at most this many bytes\n"
 "  -w, --wrap=Columns    Wrap encoded binary output within columns\n"
-"                        Default is `76`. `0` Disables linewrapping\n";
+"                        Default is `76`. `0` Disables linewrapping\n"
+"      --prefix=Text     Format each encoded byte as Prefix, its digits, and\n"
+"      --suffix=Text     Suffix, such as `--prefix=0b --separator=\", \"`.\n"
+"      --separator=Text  Separator goes before every group of bytes but the\n"
+"      --group=Bytes     first. Each text may use `\\n`, `\\r`, `\\t`, and\n"
+"                        `\\\\` escapes. Replaces --wrap when encoding, and its\n"
+"                        texts are skipped when decoding\n"
+"                        Default is no prefix or suffix, a separator of ` `,\n"
+"                        and groups of `1` byte\n"
+"  -o, --output=Path     Write to a file rather than to stdout. When Path is\n"
+"                        a directory, each input file is transcoded into a\n"
+"                        file of the same name within it\n"
+"      --files-from=List Also transcode the files listed one per line in the\n"
+"                        file List, `-` Reads the list from stdin\n"
+"  -t, --threads=Count   Encode or decode using multiple threads, or as many\n"
+"                        files at once when writing to a directory\n"
+"                        Default is `1`. `auto` Uses all hardware threads\n"
+"  -b, --buffer-size=Bytes\n"
+"                        Bytes of binary data transcoded at a time, with an\n"
+"                        optional `K`, `M`, or `G` suffix\n"
+"                        Default is sized to fit the L2 cache of each thread\n"
+"      --isa=Name        Use the kernels of an instruction set: `generic`,\n"
+"                        `sse41`, `avx2`, `avx512bw`, `avx512bitalg`,\n"
+"                        `sse41gfni`, `avx2gfni`, `avx512gfni`, `neon`\n"
+"                        Default is `auto`, the widest that is supported, or\n"
+"                        the `BASE2_ISA` environment variable\n"
+"      --stats           Print the time spent reading, transcoding, and\n"
+"                        writing, the system calls and page faults, and\n"
+"                        the amount of data, to stderr\n"
+"      --stats-json=FD   Write the same stats as JSON to file descriptor FD\n";
+
+// Value of options that only have a long form
+enum LongOption : int
+{
+	IsaOption = 0x100,
+	StatsOption,
+	StatsJsonOption,
+	FilesFromOption,
+	OffsetOption,
+	LengthOption,
+	PrefixOption,
+	SuffixOption,
+	SeparatorOption,
+	GroupOption,
+};
+
+// Prints the stats of a finished run as text to stderr and as JSON to
+// `JsonFD`, if it is not `-1`
+void ReportStats( const TranscodeStats& Stats, bool Text, int JsonFD )
+{
+	const char* const PhaseNames[TranscodeStats::PhaseCount] = {
+		"Read", "Transcode", "Write", "Wait"
+	};
+	const char* const SyscallNames[TranscodeStats::SyscallCount] = {
+		"vmsplice", "io_uring_submit", "madvise"
+	};
+	const double Wall
+		= (TranscodeStats::Now(CLOCK_MONOTONIC) - Stats.StartNs) * 1e-9;
+	// The CPU time of every thread, to the nanosecond. The split into user and
+	// system time is only sampled upon each scheduler tick, and may read as
+	// `0` for short runs.
+	const double Cpu = (
+		TranscodeStats::Now(CLOCK_PROCESS_CPUTIME_ID) - Stats.StartCpuNs
+	) * 1e-9;
+	const rusage Usage = TranscodeStats::Usage();
+	const double User = TranscodeStats::Seconds(
+		Stats.StartUsage.ru_utime, Usage.ru_utime
+	);
+	const double System = TranscodeStats::Seconds(
+		Stats.StartUsage.ru_stime, Usage.ru_stime
+	);
+	// Memory-mapped files are read and written through page faults rather
+	// than through read and write calls
+	const std::uint64_t MinorFaults
+		= Usage.ru_minflt - Stats.StartUsage.ru_minflt;
+	const std::uint64_t MajorFaults
+		= Usage.ru_majflt - Stats.StartUsage.ru_majflt;
+	std::uint64_t Reads = 0;
+	std::uint64_t Writes = 0;
+	const bool HasIo = Stats.HasProcessIo
+		&& TranscodeStats::ProcessIo(Reads, Writes);
+	Reads  = HasIo ? Reads - Stats.StartReads : 0;
+	Writes = HasIo ? Writes - Stats.StartWrites : 0;
+	const char* const Isa = Base2::IsaName(Base2::SelectedIsa());
+	const std::uint64_t BytesIn  = Stats.BytesIn.load();
+	const std::uint64_t BytesOut = Stats.BytesOut.load();
+	const std::uint64_t Garbage  = Stats.Garbage.load();
+
+	if( Text )
+	{
+		std::fprintf(
+			stderr,
+			"base2: %s, %" PRIu64 " bytes in, %" PRIu64 " bytes out, "
+			"%" PRIu64 " garbage bytes\n"
+			"  Total      %10.6fs wall  %10.6fs cpu   %8.3f GiB/s\n"
+			"             %10.6fs user  %10.6fs system\n"
+			"  Faults     %10" PRIu64 " minor %10" PRIu64 " major\n",
+			Isa, BytesIn, BytesOut, Garbage, Wall, Cpu,
+			Wall > 0.0 ? std::max(BytesIn, BytesOut) / Wall / (1 << 30) : 0.0,
+			User, System, MinorFaults, MajorFaults
+		);
+		std::fputs("  Syscalls  ", stderr);
+		if( HasIo )
+		{
+			std::fprintf(
+				stderr, " read %" PRIu64 "  write %" PRIu64, Reads, Writes
+			);
+		}
+		for( std::size_t i = 0; i < TranscodeStats::SyscallCount; ++i )
+		{
+			std::fprintf(
+				stderr, "  %s %" PRIu64, SyscallNames[i], Stats.Syscalls[i].load()
+			);
+		}
+		std::fputc('\n', stderr);
+		for( std::size_t i = 0; i < TranscodeStats::PhaseCount; ++i )
+		{
+			if( Stats.Intervals[i] == 0 ) continue;
+			std::fprintf(
+				stderr,
+				"  %-9s  %10.6fs wall  %10.6fs cpu   %10" PRIu64 " intervals\n",
+				PhaseNames[i], Stats.WallNs[i] * 1e-9, Stats.CpuNs[i] * 1e-9,
+				Stats.Intervals[i].load()
+			);
+		}
+	}
+	if( JsonFD >= 0 )
+	{
+		dprintf(
+			JsonFD,
+			"{\"Isa\": \"%s\", \"BytesIn\": %" PRIu64 ", \"BytesOut\": %" PRIu64 ", "
+			"\"Garbage\": %" PRIu64 ", \"Wall\": %.9f, \"Cpu\": %.9f, "
+			"\"User\": %.6f, \"System\": %.6f, \"MinorFaults\": %" PRIu64 ", "
+			"\"MajorFaults\": %" PRIu64 ", \"Syscalls\": {",
+			Isa, BytesIn, BytesOut, Garbage, Wall, Cpu, User, System,
+			MinorFaults, MajorFaults
+		);
+		if( HasIo )
+		{
+			dprintf(
+				JsonFD, "\"read\": %" PRIu64 ", \"write\": %" PRIu64 ", ",
+				Reads, Writes
+			);
+		}
+		for( std::size_t i = 0; i < TranscodeStats::SyscallCount; ++i )
+		{
+			dprintf(
+				JsonFD, "%s\"%s\": %" PRIu64, i ? ", " : "", SyscallNames[i],
+				Stats.Syscalls[i].load()
+			);
+		}
+		dprintf(JsonFD, "}, \"Phases\": {");
+		for( std::size_t i = 0; i < TranscodeStats::PhaseCount; ++i )
+		{
+			dprintf(
+				JsonFD,
+				"%s\"%s\": {\"Wall\": %.9f, \"Cpu\": %.9f, \"Intervals\": %" PRIu64 "}",
+				i ? ", " : "", PhaseNames[i], Stats.WallNs[i] * 1e-9,
+				Stats.CpuNs[i] * 1e-9, Stats.Intervals[i].load()
+			);
+		}
+		dprintf(JsonFD, "}}\n");
+	}
+}
 
-const static struct option CommandOptions[5] = {
+const static struct option CommandOptions[19] = {
 	{ "decode",         optional_argument, nullptr,  'd' },
 	{ "ignore-garbage", optional_argument, nullptr,  'i' },
+	{ "strict",         optional_argument, nullptr,  's' },
 	{ "wrap",           optional_argument, nullptr,  'w' },
+	{ "threads",        required_argument, nullptr,  't' },
+	{ "buffer-size",    required_argument, nullptr,  'b' },
+	{ "output",         required_argument, nullptr,  'o' },
+	{ "files-from",     required_argument, nullptr,  FilesFromOption },
+	{ "offset",         required_argument, nullptr,  OffsetOption },
+	{ "length",         required_argument, nullptr,  LengthOption },
+	{ "prefix",         required_argument, nullptr,  PrefixOption },
+	{ "suffix",         required_argument, nullptr,  SuffixOption },
+	{ "separator",      required_argument, nullptr,  SeparatorOption },
+	{ "group",          required_argument, nullptr,  GroupOption },
+	{ "isa",            required_argument, nullptr,  IsaOption },
+	{ "stats",                no_argument, nullptr,  StatsOption },
+	{ "stats-json",     required_argument, nullptr,  StatsJsonOption },
 	{ "help",           optional_argument, nullptr,  'h' },
 	{ nullptr,                no_argument, nullptr, '\0' }
 };
@@ -179,14 +2275,22 @@ const static struct option CommandOptions[5] = {
 int main( int argc, char* argv[] )
 {
 	Settings CurSettings = {};
+	bool StatsText = false;
+	int StatsJsonFD = -1;
+	const char* OutputPath = nullptr;
+	const char* FileListPath = nullptr;
+	// Texts of the format, which `CurSettings.Format` points into
+	std::string FormatTexts[3] = {"", "", " "};
+	bool WrapGiven = false;
 	int Opt;
 	int OptionIndex;
-	while( (Opt = getopt_long(argc, argv, "hdiw:", CommandOptions, &OptionIndex )) != -1 )
+	while( (Opt = getopt_long(argc, argv, "hdisw:t:b:o:", CommandOptions, &OptionIndex )) != -1 )
 	{
 		switch( Opt )
 		{
 		case 'd': CurSettings.Decode = true;            break;
 		case 'i': CurSettings.IgnoreInvalid = true;     break;
+		case 's': CurSettings.Strict = true;            break;
 		case 'w':
 		{
 			const std::intmax_t ArgWrap = std::atoi(optarg);
@@ -196,6 +2300,123 @@ int main( int argc, char* argv[] )
 				return EXIT_FAILURE;
 			}
 			CurSettings.Wrap = ArgWrap;
+			WrapGiven = true;
+			break;
+		}
+		case 't':
+		{
+			if( std::strcmp(optarg, "auto") == 0 )
+			{
+				CurSettings.Threads = 0;
+				break;
+			}
+			const std::intmax_t ArgThreads = std::atoi(optarg);
+			if( ArgThreads <= 0 )
+			{
+				std::fputs("Invalid thread count", stderr);
+				return EXIT_FAILURE;
+			}
+			CurSettings.Threads = ArgThreads;
+			break;
+		}
+		case 'b':
+		{
+			std::uint64_t ArgSize;
+			if( !ParseSize(optarg, ArgSize) || ArgSize == 0 )
+			{
+				std::fputs("Invalid buffer size", stderr);
+				return EXIT_FAILURE;
+			}
+			CurSettings.BufferSize = ArgSize;
+			break;
+		}
+		case OffsetOption:
+		{
+			if( !ParseSize(optarg, CurSettings.RangeOffset) )
+			{
+				std::fputs("Invalid offset", stderr);
+				return EXIT_FAILURE;
+			}
+			CurSettings.DecodeRange = true;
+			break;
+		}
+		case LengthOption:
+		{
+			if( !ParseSize(optarg, CurSettings.RangeLength) )
+			{
+				std::fputs("Invalid length", stderr);
+				return EXIT_FAILURE;
+			}
+			CurSettings.DecodeRange = true;
+			break;
+		}
+		case PrefixOption:
+		case SuffixOption:
+		case SeparatorOption:
+		{
+			if( !ParseText(optarg, FormatTexts[Opt - PrefixOption]) )
+			{
+				std::fprintf(stderr, "Invalid escape in text: %s\n", optarg);
+				return EXIT_FAILURE;
+			}
+			CurSettings.Formatted = true;
+			break;
+		}
+		case GroupOption:
+		{
+			std::uint64_t ArgGroup;
+			if( !ParseSize(optarg, ArgGroup) || ArgGroup == 0 )
+			{
+				std::fputs("Invalid group size", stderr);
+				return EXIT_FAILURE;
+			}
+			CurSettings.Format.GroupSize = ArgGroup;
+			CurSettings.Formatted = true;
+			break;
+		}
+		case 'o':
+		{
+			OutputPath = optarg;
+			break;
+		}
+		case FilesFromOption:
+		{
+			FileListPath = optarg;
+			break;
+		}
+		case IsaOption:
+		{
+			Base2::Isa Tier;
+			if( !Base2::ParseIsa(optarg, Tier) )
+			{
+				std::fprintf(stderr, "Unknown instruction set: %s\n", optarg);
+				return EXIT_FAILURE;
+			}
+			if( !Base2::SelectIsa(Tier) )
+			{
+				std::fprintf(
+					stderr, "Instruction set not supported by this processor: %s\n",
+					optarg
+				);
+				return EXIT_FAILURE;
+			}
+			break;
+		}
+		case StatsOption:
+		{
+			StatsText = true;
+			break;
+		}
+		case StatsJsonOption:
+		{
+			char* End = nullptr;
+			const long ArgFD = std::strtol(optarg, &End, 10);
+			if( ArgFD < 0 || *optarg == '\0' || *End != '\0' )
+			{
+				std::fputs("Invalid stats file descriptor", stderr);
+				return EXIT_FAILURE;
+			}
+			StatsJsonFD = ArgFD;
 			break;
 		}
 		case 'h':
@@ -209,18 +2430,134 @@ int main( int argc, char* argv[] )
 		}
 		}
 	}
-	if( optind < argc )
+	if( CurSettings.Strict && CurSettings.IgnoreInvalid )
+	{
+		std::fputs("--strict and --ignore-garbage are exclusive", stderr);
+		return EXIT_FAILURE;
+	}
+	if( CurSettings.DecodeRange && (!CurSettings.Decode || CurSettings.Strict) )
+	{
+		std::fputs("--offset and --length only apply to non-strict decoding", stderr);
+		return EXIT_FAILURE;
+	}
+	if( CurSettings.Formatted )
 	{
-		if( std::strcmp(argv[optind],"-") != 0 )
+		CurSettings.Format.Prefix    = FormatTexts[0].c_str();
+		CurSettings.Format.Suffix    = FormatTexts[1].c_str();
+		CurSettings.Format.Separator = FormatTexts[2].c_str();
+		if( !Base2::FormatValid(CurSettings.Format) )
 		{
-			CurSettings.InputFile = fopen(argv[optind],"rb");
-			if( CurSettings.InputFile == nullptr )
-			{
-				std::fprintf(
-					stderr, "Error opening input file: %s\n", argv[optind]
-				);
-			}
+			std::fprintf(
+				stderr,
+				"Invalid format, each text must be at most %zu bytes and not "
+				"only digits\n", Base2::MaxFormatText
+			);
+			return EXIT_FAILURE;
+		}
+		if( WrapGiven || CurSettings.Strict || CurSettings.DecodeRange )
+		{
+			std::fputs(
+				"--wrap, --strict, --offset, and --length do not apply to "
+				"formatted output", stderr
+			);
+			return EXIT_FAILURE;
+		}
+	}
+	std::vector<std::string> InputPaths(argv + optind, argv + argc);
+	if( FileListPath )
+	{
+		std::FILE* ListFile = std::strcmp(FileListPath, "-") == 0 ?
+			stdin : std::fopen(FileListPath, "r");
+		if( ListFile == nullptr )
+		{
+			std::fprintf(stderr, "Error opening file list: %s\n", FileListPath);
+			return EXIT_FAILURE;
+		}
+		ReadFileList(ListFile, InputPaths);
+		if( ListFile != stdin )
+		{
+			std::fclose(ListFile);
+		}
+	}
+	TranscodeStats Stats;
+	if( StatsText || StatsJsonFD >= 0 )
+	{
+		CurSettings.Stats = &Stats;
+	}
+
+	struct stat OutputStat;
+	if(
+		OutputPath && stat(OutputPath, &OutputStat) == 0
+		&& S_ISDIR(OutputStat.st_mode)
+	)
+	{
+		// Standard input has no name to give its output within the directory
+		if( InputPaths.empty() )
+		{
+			std::fputs("No input files for output directory", stderr);
+			return EXIT_FAILURE;
+		}
+		const bool Result = TranscodeFiles(CurSettings, OutputPath, InputPaths);
+		if( CurSettings.Stats )
+		{
+			ReportStats(Stats, StatsText, StatsJsonFD);
+		}
+		return Result;
+	}
+	if( InputPaths.size() > 1 )
+	{
+		std::fputs("Multiple input files need an output directory", stderr);
+		return EXIT_FAILURE;
+	}
+	const bool FromStdin = InputPaths.empty() || InputPaths[0] == "-";
+	if( OutputPath && !FromStdin )
+	{
+		const bool Result = TranscodeFile(
+			CurSettings, InputPaths[0].c_str(), OutputPath
+		);
+		if( CurSettings.Stats )
+		{
+			ReportStats(Stats, StatsText, StatsJsonFD);
+		}
+		return Result;
+	}
+	if( !FromStdin )
+	{
+		CurSettings.InputFile = fopen(InputPaths[0].c_str(),"rb");
+		if( CurSettings.InputFile == nullptr )
+		{
+			std::fprintf(
+				stderr, "Error opening input file: %s\n", InputPaths[0].c_str()
+			);
+			return EXIT_FAILURE;
+		}
+	}
+	if( OutputPath )
+	{
+		// Opened for reading as well, without which the file cannot be mapped
+		CurSettings.OutputFile = fopen(OutputPath,"w+b");
+		if( CurSettings.OutputFile == nullptr )
+		{
+			std::fprintf(stderr, "Error opening output file: %s\n", OutputPath);
+			return EXIT_FAILURE;
+		}
+	}
+	bool Result = (CurSettings.Decode ? Decode:Encode)(CurSettings);
+	if( OutputPath )
+	{
+		if( std::fclose(CurSettings.OutputFile) != 0 )
+		{
+			std::fputs("Error writing to output file", stderr);
+			Result = EXIT_FAILURE;
 		}
 	}
-	return (CurSettings.Decode ? Decode:Encode)(CurSettings);
+	else if( CurSettings.Stats )
+	{
+		std::fflush(CurSettings.OutputFile);
+	}
+	if( CurSettings.Stats )
+	{
+		ReportStats(Stats, StatsText, StatsJsonFD);
+	}
+	return Result;
 }
@@ -0,0 +1,273 @@
+#include <Base2.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "Base2-Wrap.hpp"
+#include "base2-test.hpp"
+
+TEST_CASE("FilterDecode clean", "[Base2]") {
+  const std::string_view Encoded = "0000000011111111101010100101010111";
+  std::vector<std::uint8_t> Output(4);
+  Base2::DecodeCarry Carry;
+  const std::size_t Decoded = Base2::FilterDecode(
+      reinterpret_cast<const std::uint8_t *>(Encoded.data()), Output.data(),
+      Encoded.size(), Carry);
+  REQUIRE(Decoded == 4);
+  REQUIRE(Output == std::vector<std::uint8_t>{0x00, 0xFF, 0xAA, 0x55});
+  REQUIRE(Carry.Count == 2);
+}
+
+TEST_CASE("FilterDecode with garbage across calls", "[Base2]") {
+  std::mt19937 Random(713);
+  const std::vector<std::uint8_t> Input = RandomBytes(100 * 1024 + 13, Random);
+  const std::string Garbled = GarbledEncoding(Input, Random);
+
+  // Calls that split groups of digits at every possible position
+  for (const std::size_t CallSize : {1, 7, 63, 64, 100, 4096, 1 << 20}) {
+    std::vector<std::uint8_t> Output;
+    Base2::DecodeCarry Carry;
+    for (std::size_t i = 0; i < Garbled.size(); i += CallSize) {
+      const std::size_t Length = std::min(CallSize, Garbled.size() - i);
+      const std::size_t Offset = Output.size();
+      Output.resize(Offset + (Carry.Count + Length) / 8);
+      const std::size_t Decoded = Base2::FilterDecode(
+          reinterpret_cast<const std::uint8_t *>(Garbled.data() + i),
+          Output.data() + Offset, Length, Carry);
+      Output.resize(Offset + Decoded);
+    }
+    REQUIRE(Output == Input);
+    REQUIRE(Carry.Count == 3);
+  }
+}
+
+TEST_CASE("DecodeChecked finds the first invalid byte", "[Base2]") {
+  const std::vector<std::uint8_t> Input = RandomBytes(713);
+
+  std::vector<std::uint64_t> Encoded(Input.size());
+  Base2::Encode(Input.data(), Encoded.data(), Input.size());
+
+  std::vector<std::uint8_t> Output(Input.size());
+  REQUIRE(Base2::DecodeChecked(Encoded.data(), Output.data(), Encoded.size()) ==
+          Encoded.size() * 8);
+  REQUIRE(Output == Input);
+
+  for (const std::size_t Offset : {0, 1, 7, 8, 63, 64, 100, 1000, 5703}) {
+    std::vector<std::uint64_t> Corrupt = Encoded;
+    reinterpret_cast<char *>(Corrupt.data())[Offset] = 'x';
+    // A second invalid byte after the first does not change the result
+    reinterpret_cast<char *>(Corrupt.data())[Corrupt.size() * 8 - 1] = '2';
+
+    std::vector<std::uint8_t> Checked(Input.size());
+    REQUIRE(Base2::DecodeChecked(Corrupt.data(), Checked.data(),
+                                 Corrupt.size()) == Offset);
+    REQUIRE(std::equal(Input.begin(), Input.begin() + Offset / 8,
+                       Checked.begin()));
+
+    REQUIRE(Base2::ParallelDecodeChecked(Corrupt.data(), Checked.data(),
+                                         Corrupt.size(), 4) == Offset);
+  }
+}
+
+TEST_CASE("ParallelDecodeChecked across chunks", "[Base2]") {
+  const std::vector<std::uint8_t> Input = RandomBytes(1024 * 1024 + 713);
+
+  std::vector<std::uint64_t> Encoded(Input.size());
+  Base2::Encode(Input.data(), Encoded.data(), Input.size());
+
+  std::vector<std::uint8_t> Output(Input.size());
+  REQUIRE(Base2::ParallelDecodeChecked(Encoded.data(), Output.data(),
+                                       Encoded.size(), 4) ==
+          Encoded.size() * 8);
+  REQUIRE(Output == Input);
+
+  // Invalid bytes in two different chunks
+  reinterpret_cast<char *>(Encoded.data())[7000000] = '\n';
+  reinterpret_cast<char *>(Encoded.data())[3000001] = ' ';
+  REQUIRE(Base2::ParallelDecodeChecked(Encoded.data(), Output.data(),
+                                       Encoded.size(), 4) == 3000001);
+}
+
+TEST_CASE("DecodeWrapped", "[Base2]") {
+  const std::vector<std::uint8_t> Input = RandomBytes(20 * 1024 + 13);
+
+  for (const std::size_t WrapWidth : {1, 8, 64, 76, 200}) {
+    std::string Encoded(Base2::WrappedSize(Input.size(), WrapWidth), '\0');
+    Base2::EncodeWrapped(Input.data(), Encoded.data(), Input.size(),
+                         WrapWidth);
+
+    std::string CRLF;
+    for (const char Digit : Encoded) {
+      CRLF += Digit == '\n' ? "\r\n" : std::string(1, Digit);
+    }
+    // Irregular lines in the middle, which are filtered instead
+    std::string Irregular = Encoded;
+    Irregular.insert(Irregular.size() / 3, "\n\n");
+    Irregular.insert(Irregular.size() / 2, "x");
+
+    for (std::string Text : {Encoded, CRLF, Irregular}) {
+      Text += "\n";
+      for (const std::size_t CallSize : {77, 4096, 1 << 20}) {
+        std::vector<std::uint8_t> Output;
+        Base2::DecodeCarry Carry;
+        for (std::size_t i = 0; i < Text.size(); i += CallSize) {
+          const std::size_t Length = std::min(CallSize, Text.size() - i);
+          const std::size_t Offset = Output.size();
+          Output.resize(Offset + (Carry.Count + Length) / 8);
+          const std::size_t Decoded = Base2::DecodeWrapped(
+              reinterpret_cast<const std::uint8_t *>(Text.data() + i),
+              Output.data() + Offset, Length, WrapWidth, Carry);
+          Output.resize(Offset + Decoded);
+        }
+        REQUIRE(Output == Input);
+        REQUIRE(Carry.Count == 0);
+      }
+    }
+  }
+}
+
+// Digits that `DecodeWrappedStaged` has fallen back to filtering
+static std::size_t FilteredDigits = 0;
+
+static std::size_t CountingFilterDecode(const std::uint8_t Input[],
+                                        std::uint8_t Output[],
+                                        std::size_t Length,
+                                        Base2::DecodeCarry &Carry) {
+  FilteredDigits += std::count_if(Input, Input + Length, [](std::uint8_t Byte) {
+    return (Byte & 0xFE) == 0x30;
+  });
+  return Base2::FilterDecode(Input, Output, Length, Carry);
+}
+
+TEST_CASE("DecodeWrapped stages a short last line", "[Base2]") {
+  // Lengths that end in a line shorter than the width
+  for (const std::size_t WrapWidth : {8, 64, 76, 200}) {
+    for (const std::size_t Size : {1, 13, 1024 + 3}) {
+      const std::vector<std::uint8_t> Input = RandomBytes(Size);
+      std::string Encoded(Base2::WrappedSize(Input.size(), WrapWidth), '\0');
+      Base2::EncodeWrapped(Input.data(), Encoded.data(), Input.size(),
+                           WrapWidth);
+
+      for (const std::string_view Ending : {"", "\n", "\r\n"}) {
+        const std::string Text = Encoded + std::string(Ending);
+        for (const std::size_t CallSize : {77, 4096, 1 << 20}) {
+          FilteredDigits = 0;
+          std::vector<std::uint8_t> Output;
+          Base2::DecodeCarry Carry;
+          for (std::size_t i = 0; i < Text.size(); i += CallSize) {
+            const std::size_t Length = std::min(CallSize, Text.size() - i);
+            const std::size_t Offset = Output.size();
+            Output.resize(Offset + (Carry.Count + Length) / 8);
+            const std::size_t Decoded = DecodeWrappedStaged(
+                Base2::DecodeChecked, CountingFilterDecode,
+                reinterpret_cast<const std::uint8_t *>(Text.data() + i),
+                Output.data() + Offset, Length, WrapWidth, Carry);
+            Output.resize(Offset + Decoded);
+          }
+          REQUIRE(Output == Input);
+          REQUIRE(FilteredDigits == 0);
+        }
+      }
+    }
+  }
+}
+
+// Decodes `Text` through `Decoder` in calls of `CallSize` bytes, stopping at
+// the first call that fails
+static std::vector<std::uint8_t> CheckedDecode(Base2::CheckedWrapDecoder &Decoder,
+                                               std::string_view Text,
+                                               std::size_t CallSize) {
+  std::vector<std::uint8_t> Output;
+  for (std::size_t i = 0; i < Text.size() && !Decoder.Failed(); i += CallSize) {
+    const std::size_t Length = std::min(CallSize, Text.size() - i);
+    const std::size_t Offset = Output.size();
+    Output.resize(Offset + Decoder.MaxOutputSize(Length));
+    const std::size_t Decoded = Decoder.Update(
+        reinterpret_cast<const std::uint8_t *>(Text.data() + i), Length,
+        Output.data() + Offset);
+    Output.resize(Offset + Decoded);
+  }
+  return Output;
+}
+
+TEST_CASE("CheckedWrapDecoder accepts wrapped layouts", "[Base2]") {
+  const std::vector<std::uint8_t> Input = RandomBytes(2 * 1024 + 13);
+
+  for (const std::size_t WrapWidth : {1, 8, 64, 76, 200}) {
+    std::string Encoded(Base2::WrappedSize(Input.size(), WrapWidth), '\0');
+    Base2::EncodeWrapped(Input.data(), Encoded.data(), Input.size(),
+                         WrapWidth);
+
+    std::string CRLF;
+    for (const char Digit : Encoded) {
+      CRLF += Digit == '\n' ? "\r\n" : std::string(1, Digit);
+    }
+    // The last line may end with or without a line ending
+    for (const std::string &Text :
+         {Encoded, Encoded + "\n", CRLF, CRLF + "\r\n"}) {
+      for (const std::size_t CallSize : {1, 2, 77, 4096, 1 << 20}) {
+        Base2::CheckedWrapDecoder Decoder(WrapWidth);
+        REQUIRE(CheckedDecode(Decoder, Text, CallSize) == Input);
+        REQUIRE_FALSE(Decoder.Failed());
+        REQUIRE(Decoder.Finish() == 0);
+      }
+    }
+  }
+}
+
+TEST_CASE("CheckedWrapDecoder rejects broken layouts", "[Base2]") {
+  struct Broken {
+    std::string_view Text;
+    std::uint64_t Offset;
+    char Byte;
+    std::string_view Decoded;
+  };
+  for (const Broken &Case : {
+           // A short line that is not the last one
+           Broken{"0100000101000010\n01000011\n0100010001000101\n", 25, '\n',
+                  "ABC"},
+           // A `\r` without a `\n`
+           Broken{"0100000101000010\r01000011", 16, '\r', "AB"},
+           Broken{"0100000101000010\r0", 16, '\r', "AB"},
+           // A line wider than the first
+           Broken{"0100000101000010\n010000110100010001000101\n", 33, '0',
+                  "ABCD"},
+           // A byte that is not a digit
+           Broken{"0100000101000010\n010000x1\n", 23, 'x', "AB"},
+       }) {
+    for (const std::size_t CallSize : {1, 3, 1 << 20}) {
+      Base2::CheckedWrapDecoder Decoder(16);
+      const std::vector<std::uint8_t> Output =
+          CheckedDecode(Decoder, Case.Text, CallSize);
+      REQUIRE(Decoder.Failed());
+      REQUIRE(Decoder.FailedOffset() == Case.Offset);
+      REQUIRE(Decoder.FailedByte() == static_cast<std::uint8_t>(Case.Byte));
+      REQUIRE(std::string_view(reinterpret_cast<const char *>(Output.data()),
+                               Output.size()) == Case.Decoded);
+    }
+  }
+
+  // A `\r` or an incomplete group that ends the input is left to `Finish`
+  for (const std::size_t CallSize : {1, 3, 1 << 20}) {
+    Base2::CheckedWrapDecoder Decoder(16);
+    REQUIRE(CheckedDecode(Decoder, "0100000101000010\r", CallSize) ==
+            std::vector<std::uint8_t>{'A', 'B'});
+    REQUIRE_FALSE(Decoder.Failed());
+    REQUIRE(Decoder.Finish() == 0);
+    REQUIRE(Decoder.Failed());
+    REQUIRE(Decoder.FailedOffset() == 16);
+  }
+  for (const std::size_t CallSize : {1, 3, 1 << 20}) {
+    Base2::CheckedWrapDecoder Decoder(16);
+    REQUIRE(CheckedDecode(Decoder, "0100000101000010\n0100", CallSize) ==
+            std::vector<std::uint8_t>{'A', 'B'});
+    REQUIRE_FALSE(Decoder.Failed());
+    REQUIRE(Decoder.Finish() == 4);
+  }
+}
@@ -3,9 +3,15 @@
 #include <algorithm>
 #include <string>
 #include <string_view>
+#include <vector>
 
 #include <catch2/catch_test_macros.hpp>
 
+#if defined(__unix__)
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
 static std::string TestEncode(std::string Input) {
   std::string Output;
   Output.resize(Input.size() * 8);
@@ -161,4 +167,220 @@ TEST_CASE("0x55 x713", "[Base2]") {
     const std::string_view CurSpan = OutputView.substr(i, 16);
     REQUIRE(CurSpan == "0101010101010101");
   }
-}
\ No newline at end of file
+}
+
+static std::string NaiveWrap(std::string_view Encoded, std::size_t WrapWidth,
+                             std::size_t Column) {
+  std::string Output;
+  for (const char Digit : Encoded) {
+    if (Column == WrapWidth) {
+      Output.push_back('\n');
+      Column = 0;
+    }
+    Output.push_back(Digit);
+    ++Column;
+  }
+  return Output;
+}
+
+TEST_CASE("EncodeWrapped", "[Base2]") {
+  std::vector<std::uint8_t> Input(713);
+  std::generate(Input.begin(), Input.end(),
+                [i = 0ULL]() mutable { return (i++ * 0x9E) >> 3; });
+  const std::string Encoded =
+      TestEncode(std::string(Input.begin(), Input.end()));
+
+  for (const std::size_t WrapWidth : {1, 7, 8, 64, 76, 100}) {
+    for (const std::size_t Column : {std::size_t(0), WrapWidth / 2, WrapWidth}) {
+      std::string Output;
+      Output.resize(Base2::WrappedSize(Input.size(), WrapWidth, Column));
+
+      const std::size_t EndColumn = Base2::EncodeWrapped(
+          Input.data(), Output.data(), Input.size(), WrapWidth, Column);
+
+      REQUIRE(Output == NaiveWrap(Encoded, WrapWidth, Column));
+      REQUIRE(EndColumn ==
+              Base2::WrappedColumn(Input.size(), WrapWidth, Column));
+    }
+  }
+}
+
+TEST_CASE("ParallelEncodeWrapped", "[Base2]") {
+  std::vector<std::uint8_t> Input(300 * 1024 + 7, 0x5A);
+  std::string Expected;
+  Expected.resize(Base2::WrappedSize(Input.size(), 76, 13));
+  Base2::EncodeWrapped(Input.data(), Expected.data(), Input.size(), 76, 13);
+
+  std::string Output;
+  Output.resize(Expected.size());
+  const std::size_t EndColumn = Base2::ParallelEncodeWrapped(
+      Input.data(), Output.data(), Input.size(), 76, 13, 3);
+
+  REQUIRE(Output == Expected);
+  REQUIRE(EndColumn == Base2::WrappedColumn(Input.size(), 76, 13));
+}
+
+TEST_CASE("Every supported Isa", "[Base2]") {
+  std::vector<std::uint8_t> Input(1031);
+  for (std::size_t i = 0; i < Input.size(); ++i) {
+    Input[i] = static_cast<std::uint8_t>(i * 2654435761u >> 13);
+  }
+  std::vector<std::uint64_t> Expected(Input.size());
+  Base2::Encode(Input.data(), Expected.data(), Input.size());
+
+  REQUIRE(Base2::IsaSupported(Base2::Isa::Auto));
+  REQUIRE(Base2::IsaSupported(Base2::SelectedIsa()));
+  for (std::uint8_t i = 0; i <= static_cast<std::uint8_t>(Base2::Isa::NEON);
+       ++i) {
+    const Base2::Isa Tier = static_cast<Base2::Isa>(i);
+    Base2::Isa Parsed;
+    REQUIRE(Base2::ParseIsa(Base2::IsaName(Tier), Parsed));
+    REQUIRE(Parsed == Tier);
+    if (!Base2::IsaSupported(Tier)) {
+      REQUIRE_FALSE(Base2::SelectIsa(Tier));
+      continue;
+    }
+
+    std::vector<std::uint64_t> Encoded(Input.size());
+    Base2::Encode(Input.data(), Encoded.data(), Input.size(), Tier);
+    REQUIRE(Encoded == Expected);
+    std::vector<std::uint8_t> Decoded(Input.size());
+    Base2::Decode(Encoded.data(), Decoded.data(), Encoded.size(), Tier);
+    REQUIRE(Decoded == Input);
+
+    REQUIRE(Base2::SelectIsa(Tier));
+    REQUIRE(Base2::SelectedIsa() != Base2::Isa::Auto);
+    std::fill(Encoded.begin(), Encoded.end(), 0);
+    Base2::Encode(Input.data(), Encoded.data(), Input.size());
+    REQUIRE(Encoded == Expected);
+  }
+  REQUIRE(Base2::SelectIsa(Base2::Isa::Auto));
+
+  Base2::Isa Parsed;
+  REQUIRE(Base2::ParseIsa("AVX2", Parsed));
+  REQUIRE(Parsed == Base2::Isa::AVX2);
+  REQUIRE_FALSE(Base2::ParseIsa("avx", Parsed));
+}
+
+TEST_CASE("Non-temporal encoding", "[Base2]") {
+  std::vector<std::uint8_t> Input(300);
+  for (std::size_t i = 0; i < Input.size(); ++i) {
+    Input[i] = static_cast<std::uint8_t>(i * 2654435761u >> 13);
+  }
+  std::vector<std::uint64_t> Expected(Input.size());
+  Base2::Encode(Input.data(), Expected.data(), Input.size());
+
+  for (std::uint8_t i = 0; i <= static_cast<std::uint8_t>(Base2::Isa::NEON);
+       ++i) {
+    if (!Base2::SelectIsa(static_cast<Base2::Isa>(i))) {
+      continue;
+    }
+    // Every alignment of the output to a vector, and lengths that end before
+    // and after the first aligned vector
+    std::vector<std::uint64_t> Encoded(Input.size() + 8);
+    for (std::size_t Offset = 0; Offset < 8; ++Offset) {
+      for (std::size_t Length : {0, 1, 3, 7, 8, 9, 17, 64, 255, 300}) {
+        std::fill(Encoded.begin(), Encoded.end(), 0);
+        Base2::EncodeNonTemporal(Input.data(), Encoded.data() + Offset,
+                                 Length);
+        REQUIRE(std::equal(Expected.begin(), Expected.begin() + Length,
+                           Encoded.begin() + Offset));
+        REQUIRE(std::all_of(Encoded.begin() + Offset + Length, Encoded.end(),
+                            [](std::uint64_t Word) { return Word == 0; }));
+      }
+    }
+  }
+  REQUIRE(Base2::SelectIsa(Base2::Isa::Auto));
+
+  // Every output streams past the cache with a threshold of `0`
+  const std::size_t Threshold = Base2::NonTemporalThreshold();
+  Base2::SetNonTemporalThreshold(0);
+  std::vector<std::uint64_t> Encoded(Input.size());
+  Base2::Encode(Input.data(), Encoded.data(), Input.size());
+  REQUIRE(Encoded == Expected);
+  std::fill(Encoded.begin(), Encoded.end(), 0);
+  Base2::ParallelEncode(Input.data(), Encoded.data(), Input.size());
+  REQUIRE(Encoded == Expected);
+  Base2::SetNonTemporalThreshold(Threshold);
+  REQUIRE(Base2::NonTemporalThreshold() == Threshold);
+}
+
+#if defined(__unix__)
+// Pages with an inaccessible page on either side, so that any access past
+// either end of a buffer placed against them faults
+class GuardedPages {
+public:
+  explicit GuardedPages(std::size_t MinSize)
+      : Page(sysconf(_SC_PAGE_SIZE)),
+        Size((MinSize + Page - 1) / Page * Page) {
+    Base = static_cast<std::uint8_t *>(
+        mmap(nullptr, Size + 2 * Page, PROT_READ | PROT_WRITE,
+             MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+    REQUIRE(Base != MAP_FAILED);
+    mprotect(Base, Page, PROT_NONE);
+    mprotect(Base + Page + Size, Page, PROT_NONE);
+  }
+  ~GuardedPages() { munmap(Base, Size + 2 * Page); }
+
+  // `Length` bytes against the leading or the trailing guard page
+  std::uint8_t *Place(std::size_t Length, bool AtEnd) const {
+    return AtEnd ? Base + Page + Size - Length : Base + Page;
+  }
+
+private:
+  std::size_t Page;
+  std::size_t Size;
+  std::uint8_t *Base;
+};
+
+TEST_CASE("Kernels stay within their buffers", "[Base2]") {
+  constexpr std::size_t MaxLength = 80;
+  constexpr std::size_t WrapWidth = 12;
+  std::vector<std::uint8_t> Input(MaxLength);
+  for (std::size_t i = 0; i < Input.size(); ++i) {
+    Input[i] = static_cast<std::uint8_t>(i * 2654435761u >> 13);
+  }
+  std::vector<std::uint64_t> Expected(MaxLength);
+  Base2::Encode(Input.data(), Expected.data(), MaxLength);
+
+  const GuardedPages Binary(MaxLength);
+  const GuardedPages Ascii(Base2::WrappedSize(MaxLength, WrapWidth));
+  for (std::uint8_t i = 0; i <= static_cast<std::uint8_t>(Base2::Isa::NEON);
+       ++i) {
+    if (!Base2::SelectIsa(static_cast<Base2::Isa>(i))) {
+      continue;
+    }
+    for (std::size_t Length = 0; Length <= MaxLength; ++Length) {
+      for (const bool AtEnd : {false, true}) {
+        std::uint8_t *const In = Binary.Place(Length, AtEnd);
+        std::uint8_t *const Out = Ascii.Place(Length * 8, AtEnd);
+        std::uint64_t *const OutWords = reinterpret_cast<std::uint64_t *>(Out);
+        std::copy_n(Input.begin(), Length, In);
+
+        Base2::Encode(In, OutWords, Length);
+        REQUIRE(std::equal(OutWords, OutWords + Length, Expected.begin()));
+        Base2::EncodeNonTemporal(In, OutWords, Length);
+        REQUIRE(std::equal(OutWords, OutWords + Length, Expected.begin()));
+
+        Base2::Decode(OutWords, In, Length);
+        REQUIRE(std::equal(In, In + Length, Input.begin()));
+        REQUIRE(Base2::DecodeChecked(OutWords, In, Length) == Length * 8);
+        Base2::DecodeCarry Carry;
+        REQUIRE(Base2::FilterDecode(Out, In, Length * 8, Carry) == Length);
+        REQUIRE(Base2::Filter(Out, Length * 8) == Length * 8);
+
+        const std::size_t Size = Base2::WrappedSize(Length, WrapWidth);
+        char *const Wrapped =
+            reinterpret_cast<char *>(Ascii.Place(Size, AtEnd));
+        Base2::EncodeWrapped(In, Wrapped, Length, WrapWidth);
+        Carry = {};
+        REQUIRE(Base2::DecodeWrapped(
+                    reinterpret_cast<const std::uint8_t *>(Wrapped), In, Size,
+                    WrapWidth, Carry) == Length);
+        REQUIRE(std::equal(In, In + Length, Input.begin()));
+      }
+    }
+  }
+  REQUIRE(Base2::SelectIsa(Base2::Isa::Auto));
+}
+#endif
@@ -0,0 +1,170 @@
+#include <Base2.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "base2-test.hpp"
+
+namespace {
+// Formats `Length` bytes of `Input` one at a time, as the stream that starts
+// `Position` bytes before it would have them
+std::string FormatReference(const std::uint8_t Input[], std::size_t Length,
+                            const Base2::Format &Format,
+                            std::uint64_t Position) {
+  std::string Output;
+  for (std::size_t i = 0; i < Length; ++i, ++Position) {
+    if (Position && Position % Format.GroupSize == 0) {
+      Output += Format.Separator;
+    }
+    Output += Format.Prefix;
+    for (int Bit = 7; Bit >= 0; --Bit) {
+      Output += static_cast<char>('0' + ((Input[i] >> Bit) & 1));
+    }
+    Output += Format.Suffix;
+  }
+  return Output;
+}
+
+const Base2::Format Formats[] = {
+    {"", "", " ", 1},        {"0b", "", ", ", 1},
+    {"", "", "", 1},         {"", "", " ", 4},
+    {"0b", "", "\n", 8},     {"[", "]", "", 1},
+    {"b'", "'", " | ", 3},   {"0123456789abcdef", "}", "\r\n", 1},
+    {"", "", "---", 1000},   {"x", "y", "0z0", 2},
+    {"0123456789abcdef", "fedcba9876543210", "<<<<<<<<<<<<<<<<", 1},
+};
+} // namespace
+
+TEST_CASE("FormatValid", "[Base2]") {
+  for (const Base2::Format &Format : Formats) {
+    REQUIRE(Base2::FormatValid(Format));
+  }
+  REQUIRE_FALSE(Base2::FormatValid({"", "", " ", 0}));
+  REQUIRE_FALSE(Base2::FormatValid({"01", "", " ", 1}));
+  REQUIRE_FALSE(Base2::FormatValid({"", "", "0123456789abcdefg", 1}));
+}
+
+TEST_CASE("EncodeFormatted matches a reference", "[Base2]") {
+  const std::vector<std::uint8_t> Input = RandomBytes(3 * 1024 + 77, 25);
+  for (std::uint8_t i = 0; i <= static_cast<std::uint8_t>(Base2::Isa::NEON);
+       ++i) {
+    if (!Base2::SelectIsa(static_cast<Base2::Isa>(i))) {
+      continue;
+    }
+    for (const Base2::Format &Format : Formats) {
+      for (const std::uint64_t Position : {0, 1, 5, 1023}) {
+        for (const std::size_t Length :
+             {std::size_t(0), std::size_t(1), std::size_t(9), std::size_t(64),
+              std::size_t(600), Input.size()}) {
+          const std::string Expected =
+              FormatReference(Input.data(), Length, Format, Position);
+          REQUIRE(Base2::FormattedSize(Length, Format, Position) ==
+                  Expected.size());
+          // Nothing is written past the formatted size
+          std::string Encoded(Expected.size() + 64, '\0');
+          REQUIRE(Base2::EncodeFormatted(Input.data(), Encoded.data(), Length,
+                                         Format, Position) == Expected.size());
+          REQUIRE(Encoded.compare(0, Expected.size(), Expected) == 0);
+          REQUIRE(std::all_of(Encoded.begin() + Expected.size(), Encoded.end(),
+                              [](char Byte) { return Byte == '\0'; }));
+        }
+      }
+    }
+  }
+  REQUIRE(Base2::SelectIsa(Base2::Isa::Auto));
+}
+
+TEST_CASE("ParallelEncodeFormatted", "[Base2]") {
+  const std::vector<std::uint8_t> Input = RandomBytes(300 * 1024 + 5, 26);
+  for (const Base2::Format &Format : Formats) {
+    const std::string Expected =
+        FormatReference(Input.data(), Input.size(), Format, 3);
+    std::string Encoded(Expected.size(), '\0');
+    REQUIRE(Base2::ParallelEncodeFormatted(Input.data(), Encoded.data(),
+                                           Input.size(), Format, 3,
+                                           4) == Expected.size());
+    REQUIRE(Encoded == Expected);
+  }
+}
+
+TEST_CASE("FormattedEncoder in pieces", "[Base2]") {
+  const std::vector<std::uint8_t> Input = RandomBytes(10 * 1024 + 9, 29);
+  std::mt19937 Random(30);
+  for (std::uint8_t i = 0; i <= static_cast<std::uint8_t>(Base2::Isa::NEON);
+       ++i) {
+    if (!Base2::SelectIsa(static_cast<Base2::Isa>(i))) {
+      continue;
+    }
+    for (const Base2::Format &Format : Formats) {
+      // One encoder is shared by every piece of the stream
+      const Base2::FormattedEncoder Encoder(Format);
+      const std::string Expected =
+          FormatReference(Input.data(), Input.size(), Format, 0);
+      std::string Encoded(Expected.size(), '\0');
+      std::size_t Written = 0;
+      for (std::size_t Offset = 0; Offset < Input.size();) {
+        const std::size_t Length =
+            std::min<std::size_t>(Random() % 2000, Input.size() - Offset);
+        Written += Encoder.Encode(Input.data() + Offset,
+                                  Encoded.data() + Written, Length, Offset);
+        Offset += Length;
+      }
+      REQUIRE(Written == Expected.size());
+      REQUIRE(Encoded == Expected);
+    }
+  }
+  REQUIRE(Base2::SelectIsa(Base2::Isa::Auto));
+}
+
+TEST_CASE("FormattedDecoder round trip", "[Base2]") {
+  const std::vector<std::uint8_t> Input = RandomBytes(20 * 1024 + 3, 27);
+  std::mt19937 Random(28);
+  for (const Base2::Format &Format : Formats) {
+    const std::string Encoded =
+        FormatReference(Input.data(), Input.size(), Format, 0);
+    // Chunks of every size up to a text, and much larger ones
+    for (const std::size_t MaxChunk : {1, 3, 17, 5000}) {
+      Base2::FormattedDecoder Decoder(Format);
+      std::vector<std::uint8_t> Decoded(Encoded.size() / 8 + 1);
+      std::size_t Written = 0;
+      for (std::size_t Offset = 0; Offset < Encoded.size();) {
+        const std::size_t Chunk =
+            std::min(1 + Random() % MaxChunk, Encoded.size() - Offset);
+        REQUIRE(Decoder.MaxOutputSize(Chunk) <= Decoded.size() - Written);
+        Written += Decoder.Update(
+            reinterpret_cast<const std::uint8_t *>(Encoded.data()) + Offset,
+            Chunk, Decoded.data() + Written);
+        Offset += Chunk;
+      }
+      Written += Decoder.Finish(Decoded.data() + Written);
+      REQUIRE(Written == Input.size());
+      REQUIRE(std::equal(Input.begin(), Input.end(), Decoded.begin()));
+    }
+  }
+}
+
+TEST_CASE("FormattedDecoder tolerates other spacing", "[Base2]") {
+  const Base2::Format Format = {"0b", "", ", ", 1};
+  const std::string Encoded = "0b01000001,0b01000010\r\n  0b01000011 ,0b0100";
+  Base2::FormattedDecoder Decoder(Format);
+  std::uint8_t Decoded[8] = {};
+  std::size_t Written = Decoder.Update(
+      reinterpret_cast<const std::uint8_t *>(Encoded.data()), Encoded.size(),
+      Decoded);
+  Written += Decoder.Finish(Decoded + Written);
+  REQUIRE(Written == 3);
+  REQUIRE(std::string(Decoded, Decoded + 3) == "ABC");
+
+  // The decoder starts over after `Finish`
+  const std::string Next = "0b00110000";
+  Written = Decoder.Update(reinterpret_cast<const std::uint8_t *>(Next.data()),
+                           Next.size(), Decoded);
+  Written += Decoder.Finish(Decoded + Written);
+  REQUIRE(Written == 1);
+  REQUIRE(Decoded[0] == '0');
+}
@@ -0,0 +1,64 @@
+#include <Base2.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "base2-test.hpp"
+
+TEST_CASE("ParallelEncode matches Encode", "[Base2]") {
+  const std::vector<std::uint8_t> Input = RandomBytes(1024 * 1024 + 713);
+
+  std::vector<std::uint64_t> Expected(Input.size());
+  Base2::Encode(Input.data(), Expected.data(), Input.size());
+
+  for (const std::size_t ThreadCount : {0, 1, 2, 3, 8}) {
+    std::vector<std::uint64_t> Output(Input.size());
+    Base2::ParallelEncode(Input.data(), Output.data(), Input.size(),
+                          ThreadCount);
+    REQUIRE(Output == Expected);
+  }
+}
+
+TEST_CASE("ParallelEncode small input", "[Base2]") {
+  const std::uint8_t Input[3] = {0x00, 0xFF, 0x55};
+  std::uint64_t Output[3];
+
+  Base2::ParallelEncode(Input, Output, 3, 4);
+
+  REQUIRE(std::string_view(reinterpret_cast<const char *>(Output), 24) ==
+          "000000001111111101010101");
+}
+
+TEST_CASE("ParallelFilterDecode with garbage", "[Base2]") {
+  std::mt19937 Random(713);
+  const std::vector<std::uint8_t> Input = RandomBytes(300 * 1024 + 13, Random);
+  const std::string Garbled = GarbledEncoding(Input, Random);
+
+  for (const std::size_t ThreadCount : {1, 2, 5}) {
+    std::string Scratch = Garbled;
+    std::vector<std::uint8_t> Output(Input.size());
+    const std::size_t Digits = Base2::ParallelFilterDecode(
+        reinterpret_cast<std::uint8_t *>(Scratch.data()), Output.data(),
+        Scratch.size(), ThreadCount);
+    REQUIRE(Digits == Input.size() * 8 + 3);
+    REQUIRE(Output == Input);
+    REQUIRE(Scratch.substr(0, 3) == "101");
+  }
+}
+
+TEST_CASE("ParallelDecode matches Decode", "[Base2]") {
+  const std::vector<std::uint8_t> Input = RandomBytes(1024 * 1024 + 713);
+
+  std::vector<std::uint64_t> Encoded(Input.size());
+  Base2::Encode(Input.data(), Encoded.data(), Input.size());
+
+  std::vector<std::uint8_t> Output(Input.size());
+  Base2::ParallelDecode(Encoded.data(), Output.data(), Encoded.size(), 4);
+  REQUIRE(Output == Input);
+}
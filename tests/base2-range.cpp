@@ -0,0 +1,98 @@
+#include <Base2.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "base2-test.hpp"
+
+namespace {
+// Decodes every range of a few lengths out of `Encoded` and compares it to
+// the same range of `Input`. Input that is not regular is only found to be so
+// once a range does not agree with the layout.
+void RequireRanges(const std::vector<std::uint8_t> &Input,
+                   const std::string &Encoded, bool Regular) {
+  Base2::RangeDecoder Decoder(
+      reinterpret_cast<const std::uint8_t *>(Encoded.data()), Encoded.size());
+  std::vector<std::uint8_t> Output(Input.size() + 16);
+  for (const std::size_t Length : {1, 7, 100, 4000}) {
+    for (std::size_t Offset = 0; Offset <= Input.size() + 2;
+         Offset += 1 + Offset / 3) {
+      const std::size_t Expected =
+          std::min(Length, Input.size() - std::min(Offset, Input.size()));
+      REQUIRE(Decoder.Decode(Offset, Length, Output.data()) == Expected);
+      REQUIRE(std::equal(Output.begin(), Output.begin() + Expected,
+                         Input.begin() + std::min(Offset, Input.size())));
+    }
+  }
+  REQUIRE(Decoder.Regular() == Regular);
+}
+} // namespace
+
+TEST_CASE("WrappedOffset matches EncodeWrapped", "[Base2]") {
+  const std::uint8_t Input[40] = {};
+  for (const std::size_t WrapWidth : {0, 1, 7, 8, 76}) {
+    std::string Encoded(Base2::WrappedSize(40, WrapWidth), '\0');
+    Base2::EncodeWrapped(Input, Encoded.data(), 40, WrapWidth);
+    for (std::size_t Offset = 0; Offset < 40; ++Offset) {
+      const std::size_t Position = Base2::WrappedOffset(Offset, WrapWidth);
+      REQUIRE(Encoded[Position] == '0');
+      REQUIRE(std::size_t(std::count(Encoded.begin(),
+                                     Encoded.begin() + Position, '0')) ==
+              Offset * 8);
+    }
+  }
+}
+
+TEST_CASE("RangeDecoder of regular input", "[Base2]") {
+  const std::vector<std::uint8_t> Input = RandomBytes(10 * 1024 + 13);
+
+  for (const std::size_t WrapWidth : {0, 1, 64, 76}) {
+    std::string Encoded(Base2::WrappedSize(Input.size(), WrapWidth), '\0');
+    Base2::EncodeWrapped(Input.data(), Encoded.data(), Input.size(),
+                         WrapWidth);
+    RequireRanges(Input, Encoded, true);
+    RequireRanges(Input, Encoded + "\n", true);
+
+    // The same layout with `\r\n` line endings
+    std::string Windows;
+    for (const char Byte : Encoded) {
+      if (Byte == '\n') {
+        Windows += '\r';
+      }
+      Windows += Byte;
+    }
+    RequireRanges(Input, Windows + "\r\n", true);
+  }
+}
+
+TEST_CASE("RangeDecoder of irregular input", "[Base2]") {
+  std::mt19937 Random(713);
+  const std::vector<std::uint8_t> Input = RandomBytes(300 * 1024 + 13, Random);
+  std::vector<std::uint64_t> Digits(Input.size());
+  Base2::Encode(Input.data(), Digits.data(), Input.size());
+  const std::string Plain(reinterpret_cast<const char *>(Digits.data()),
+                          Digits.size() * 8);
+
+  // Lines of random widths
+  std::string Lines;
+  for (std::size_t i = 0; i < Plain.size();) {
+    const std::size_t Width =
+        std::min<std::size_t>(1 + Random() % 100, Plain.size() - i);
+    Lines.append(Plain, i, Width);
+    Lines += '\n';
+    i += Width;
+  }
+  RequireRanges(Input, Lines, false);
+
+  // Regular lines with garbage within them, which the ranges after the
+  // garbage find to be irregular
+  std::string Garbage(Base2::WrappedSize(Input.size(), 76), '\0');
+  Base2::EncodeWrapped(Input.data(), Garbage.data(), Input.size(), 76);
+  Garbage.insert(Garbage.size() / 2, "garbage");
+  RequireRanges(Input, Garbage, false);
+}
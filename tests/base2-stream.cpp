@@ -0,0 +1,65 @@
+#include <Base2.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "base2-test.hpp"
+
+TEST_CASE("StreamEncoder matches EncodeWrapped", "[Base2]") {
+  std::mt19937 Random(713);
+  const std::vector<std::uint8_t> Input = RandomBytes(10 * 1024 + 13, Random);
+
+  for (const std::size_t WrapWidth : {0, 1, 76}) {
+    std::string Expected(Base2::WrappedSize(Input.size(), WrapWidth), '\0');
+    Base2::EncodeWrapped(Input.data(), Expected.data(), Input.size(),
+                         WrapWidth);
+
+    Base2::StreamEncoder Encoder(WrapWidth);
+    std::string Encoded;
+    for (std::size_t i = 0; i < Input.size();) {
+      const std::size_t Length =
+          std::min<std::size_t>(1 + Random() % 300, Input.size() - i);
+      const std::size_t Offset = Encoded.size();
+      Encoded.resize(Offset + Encoder.OutputSize(Length));
+      REQUIRE(Encoder.Update(Input.data() + i, Length,
+                             Encoded.data() + Offset) ==
+              Encoded.size() - Offset);
+      i += Length;
+    }
+    REQUIRE(Encoded == Expected);
+  }
+}
+
+TEST_CASE("StreamDecoder round trip", "[Base2]") {
+  std::mt19937 Random(713);
+  const std::vector<std::uint8_t> Input = RandomBytes(10 * 1024 + 13, Random);
+
+  for (const std::size_t WrapWidth : {0, 76}) {
+    std::string Encoded(Base2::WrappedSize(Input.size(), 76), '\0');
+    Base2::EncodeWrapped(Input.data(), Encoded.data(), Input.size(), 76);
+    Encoded += "10";
+
+    Base2::StreamDecoder Decoder(WrapWidth);
+    std::vector<std::uint8_t> Decoded;
+    for (std::size_t i = 0; i < Encoded.size();) {
+      const std::size_t Length =
+          std::min<std::size_t>(1 + Random() % 300, Encoded.size() - i);
+      const std::size_t Offset = Decoded.size();
+      Decoded.resize(Offset + Decoder.MaxOutputSize(Length));
+      const std::size_t Written = Decoder.Update(
+          reinterpret_cast<const std::uint8_t *>(Encoded.data() + i), Length,
+          Decoded.data() + Offset);
+      Decoded.resize(Offset + Written);
+      i += Length;
+    }
+    REQUIRE(Decoded == Input);
+    // The two trailing digits never completed a group
+    REQUIRE(Decoder.Finish() == 2);
+    REQUIRE(Decoder.Finish() == 0);
+  }
+}
@@ -0,0 +1,46 @@
+#pragma once
+#include <Base2.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Inputs shared by the test cases
+
+// `Length` random bytes drawn from `Random`
+inline std::vector<std::uint8_t> RandomBytes(std::size_t Length,
+                                             std::mt19937 &Random) {
+  std::vector<std::uint8_t> Bytes(Length);
+  std::generate(Bytes.begin(), Bytes.end(),
+                [&Random]() { return static_cast<std::uint8_t>(Random()); });
+  return Bytes;
+}
+
+inline std::vector<std::uint8_t> RandomBytes(std::size_t Length,
+                                             unsigned Seed = 713) {
+  std::mt19937 Random(Seed);
+  return RandomBytes(Length, Random);
+}
+
+// Encoding of `Input` with garbage inserted at varying densities, and three
+// trailing digits that do not form a complete group
+inline std::string GarbledEncoding(const std::vector<std::uint8_t> &Input,
+                                   std::mt19937 &Random) {
+  std::vector<std::uint64_t> Encoded(Input.size());
+  Base2::Encode(Input.data(), Encoded.data(), Input.size());
+  const std::string_view EncodedView(
+      reinterpret_cast<const char *>(Encoded.data()), Encoded.size() * 8);
+
+  std::string Garbled;
+  for (std::size_t i = 0; i < EncodedView.size(); ++i) {
+    Garbled.push_back(EncodedView[i]);
+    while (Random() % (2 + (i / 100000) % 4) == 0) {
+      Garbled.push_back("\nx \r"[Random() % 4]);
+    }
+  }
+  Garbled += "101";
+  return Garbled;
+}